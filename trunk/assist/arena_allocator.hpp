@@ -0,0 +1,224 @@
+#ifndef ASSIST_ARENA_ALLOCATOR_HPP
+#define ASSIST_ARENA_ALLOCATOR_HPP
+
+/*
+ * assist/arena_allocator.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* A monotonic arena and an allocator drawing from it, for adapters that
+ * live only as long as one request or one function call:
+ *
+ *     char buffer[4096];
+ *     arena a(buffer, sizeof buffer);
+ *     typedef std::pair<int, int> value_type;
+ *     typedef std::vector< value_type, arena_allocator<value_type> > base;
+ *     std::less<int> cmp;
+ *     map_adapter<base> m(cmp, arena_allocator<value_type>(a));
+ *
+ * Allocating bumps a pointer; deallocating does nothing, except that
+ * the most recent block is handed back, and the memory is only returned
+ * when the arena is released or destroyed.  Start it in a buffer on the
+ * stack and small adapters never touch the heap at all.
+ *
+ * Each reallocation of a growing vector leaves the old block behind, so
+ * reserve() up front where the size is known.  An arena isn't thread
+ * safe; give each thread its own.
+ */
+
+#include <new> // operator new, bad_alloc
+#include <cstddef> // size_t, ptrdiff_t
+
+#include "detail/config.hpp"
+
+#ifdef ASSIST_HAS_CXX11
+#include <type_traits> // true_type
+#include <utility> // forward
+#endif
+
+namespace assist {
+
+namespace detail {
+
+#ifdef ASSIST_HAS_CXX11
+template < typename T >
+struct alignment_of {
+    static std::size_t const value = alignof(T);
+};
+#else
+// A T after a char is padded out to T's alignment
+template < typename T >
+struct alignment_probe {
+    char c;
+    T t;
+};
+template < typename T >
+struct alignment_of {
+    static std::size_t const value = sizeof(alignment_probe<T>) - sizeof(T);
+};
+#endif
+
+} // namespace detail
+
+class arena {
+    // Each chunk from the heap starts with one of these
+    struct chunk {
+        chunk *next;
+    };
+
+    char *initial;
+    std::size_t initial_size;
+    char *cur;
+    char *stop;
+    chunk *chunks;
+    std::size_t next_size;
+    std::size_t allocated_bytes;
+
+    // non-copyable
+    arena(arena const &);
+    arena &operator=(arena const &);
+
+    static char *align_up(char *p, std::size_t align) {
+        std::size_t const mis = reinterpret_cast<std::size_t>(p) % align;
+        return mis ? p + (align - mis) : p;
+    }
+    void refill(std::size_t n, std::size_t align) {
+        std::size_t size = next_size;
+        while ( size < sizeof(chunk) + align + n ) size *= 2;
+        chunk *const c = static_cast<chunk *>(::operator new(size));
+        c->next = chunks;
+        chunks = c;
+        cur = reinterpret_cast<char *>(c + 1);
+        stop = reinterpret_cast<char *>(c) + size;
+        // grows geometrically, so n allocations take O(log n) chunks
+        next_size = size * 2;
+    }
+
+  public:
+    // Construct/Copy/Destroy
+    explicit arena(std::size_t first_chunk = 4096)
+     : initial(0), initial_size(0), cur(0), stop(0), chunks(0),
+       next_size(first_chunk > sizeof(chunk) ? first_chunk : 64),
+       allocated_bytes(0) {}
+    // Hands out buffer[0,size) first; the buffer must outlive the arena
+    arena(void *buffer, std::size_t size)
+     : initial(static_cast<char *>(buffer)), initial_size(size),
+       cur(initial), stop(initial + size), chunks(0),
+       next_size(size > 64 ? size : 64), allocated_bytes(0) {}
+    ~arena() { release(); }
+
+    void *allocate(std::size_t n, std::size_t align) {
+        char *p = align_up(cur, align);
+        if ( !cur || p > stop || std::size_t(stop - p) < n ) {
+            refill(n, align);
+            p = align_up(cur, align);
+        }
+        cur = p + n;
+        allocated_bytes += n;
+        return p;
+    }
+    // Only the block allocated last is taken back
+    void deallocate(void *p, std::size_t n) {
+        if ( static_cast<char *>(p) + n == cur ) {
+            cur = static_cast<char *>(p);
+            allocated_bytes -= n;
+        }
+    }
+    // Frees every chunk, and starts again at the beginning of the buffer.
+    // Everything allocated from the arena is gone.
+    void release() {
+        while ( chunks ) {
+            chunk *const next = chunks->next;
+            ::operator delete(chunks);
+            chunks = next;
+        }
+        cur = initial;
+        stop = initial + initial_size;
+        allocated_bytes = 0;
+    }
+
+    // Bytes handed out and not yet released
+    std::size_t allocated() const { return allocated_bytes; }
+};
+
+template < typename T >
+class arena_allocator {
+    arena *a;
+
+  public:
+    // Types
+    typedef T value_type;
+    typedef T *pointer;
+    typedef T const *const_pointer;
+    typedef T &reference;
+    typedef T const &const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    template < typename U >
+    struct rebind {
+        typedef arena_allocator<U> other;
+    };
+#ifdef ASSIST_HAS_CXX11
+    // The memory belongs to the arena, so it goes where the arena goes
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+#endif
+
+    // Construct/Copy/Destroy
+    explicit arena_allocator(arena &source) : a(&source) {}
+    template < typename U >
+    arena_allocator(arena_allocator<U> const &other)
+     : a(&other.get_arena()) {}
+    // default copy ctr
+    // default destructor
+    // default assignment
+
+    arena &get_arena() const { return *a; }
+
+    pointer address(reference r) const { return &r; }
+    const_pointer address(const_reference r) const { return &r; }
+
+    pointer allocate(size_type n, void const * = 0) {
+        if ( n > max_size() ) throw std::bad_alloc();
+        return static_cast<pointer>(
+            a->allocate(n * sizeof(T), detail::alignment_of<T>::value));
+    }
+    void deallocate(pointer p, size_type n) {
+        a->deallocate(p, n * sizeof(T));
+    }
+    size_type max_size() const { return size_type(-1) / sizeof(T); }
+
+#ifdef ASSIST_HAS_CXX11
+    template < typename U, typename... Args >
+    void construct(U *p, Args &&...args) {
+        ::new(static_cast<void *>(p)) U(std::forward<Args>(args)...);
+    }
+    template < typename U >
+    void destroy(U *p) { p->~U(); }
+#else
+    void construct(pointer p, const_reference v) {
+        ::new(static_cast<void *>(p)) T(v);
+    }
+    void destroy(pointer p) { p->~T(); }
+#endif
+};
+
+// Comparison Operators
+// Allocators on the same arena can free each other's memory
+template < typename T, typename U >
+bool operator==(arena_allocator<T> const &lhs, arena_allocator<U> const &rhs) {
+    return &lhs.get_arena() == &rhs.get_arena();
+}
+template < typename T, typename U >
+bool operator!=(arena_allocator<T> const &lhs, arena_allocator<U> const &rhs) {
+    return !(lhs == rhs);
+}
+
+} // namespace assist
+
+#endif
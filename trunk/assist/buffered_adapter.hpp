@@ -0,0 +1,230 @@
+#ifndef ASSIST_BUFFERED_ADAPTER_HPP
+#define ASSIST_BUFFERED_ADAPTER_HPP
+
+/*
+ * assist/buffered_adapter.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* Insert-heavy front end for any of the four sorted adapters.
+ * Elements are inserted into a small level 0 adapter; once a level
+ * reaches its capacity (merge_threshold() << level) it is merged into
+ * the next one, as in Bentley and Saxe's logarithmic method.  Each
+ * element is merged O(log n) times, so inserts are amortised O(log n)
+ * instead of the O(n) shift of inserting into one big vector.
+ * Lookups probe every non-empty level, smallest first.
+ *
+ * Ordered iteration needs everything in one level: call merged(),
+ * which flushes, and iterate over that.
+ */
+
+#include <vector>
+#include <iterator> // back_inserter
+#include <algorithm> // merge, equal_range
+#include <climits> // CHAR_BIT
+
+#include "set_adapter.hpp"
+#include "map_adapter.hpp"
+#include "multiset_adapter.hpp"
+#include "multimap_adapter.hpp"
+#include "detail/config.hpp"
+#include "detail/key_extractor.hpp"
+#include "detail/adapter_traits.hpp"
+
+namespace assist {
+
+template < typename adapter_type >
+class buffered_adapter {
+  public:
+    // Types
+    typedef adapter_type adapter;
+    typedef typename adapter_type::key_type key_type;
+    typedef typename adapter_type::value_type value_type;
+    typedef typename adapter_type::key_compare key_compare;
+    typedef typename adapter_type::value_compare value_compare;
+    typedef typename adapter_type::size_type size_type;
+    typedef typename adapter_type::allocator_type allocator_type;
+
+  private:
+    // never reallocated (see the constructor), so levels are never copied
+    std::vector<adapter_type> levels;
+    size_type threshold;
+    key_compare comparator;
+    // every level, and every merge, allocates from this
+    allocator_type alloc;
+
+    static bool const unique = detail::is_unique_adapter<adapter_type>::value;
+
+    size_type capacity(size_type level) const { return threshold << level; }
+
+    // Merges newer into older, leaving newer empty.  Equivalent
+    // elements keep insertion order: older ones come first.
+    template < typename base_type >
+    static void merge_bases(base_type const &o, base_type const &n,
+                            adapter_type &older, adapter_type &newer) {
+        base_type both(o.get_allocator());
+        both.reserve(o.size() + n.size());
+        std::merge(o.begin(), o.end(), n.begin(), n.end(),
+                   std::back_inserter(both), older.value_comp());
+        older.swap(typename detail::sorted_tag<adapter_type>::type(), both);
+        newer.clear();
+    }
+    void merge_into_next(size_type level) {
+        if ( level+1 == levels.size() ) {
+            levels.push_back(adapter_type(comparator, alloc));
+        }
+        adapter_type &older = levels[level+1], &newer = levels[level];
+        merge_bases(older.base(), newer.base(), older, newer);
+    }
+    // Cascades full levels upwards, starting from level
+    void carry(size_type level) {
+        while ( levels[level].size() >= capacity(level) ) {
+            merge_into_next(level);
+            ++level;
+        }
+    }
+
+  public:
+    // Construct/Copy/Destroy
+    explicit buffered_adapter(size_type merge_threshold = 1024,
+                              const key_compare &cmp = key_compare(),
+                              const allocator_type &a = allocator_type())
+     : threshold(merge_threshold ? merge_threshold : 1), comparator(cmp),
+       alloc(a) {
+        // one level per bit of size_type is more than can ever fill
+        levels.reserve(sizeof(size_type)*CHAR_BIT);
+        levels.push_back(adapter_type(comparator, alloc));
+    }
+    buffered_adapter(buffered_adapter const &other)
+     : threshold(other.threshold), comparator(other.comparator),
+       alloc(other.alloc) {
+        levels.reserve(sizeof(size_type)*CHAR_BIT);
+        levels.insert(levels.end(), other.levels.begin(), other.levels.end());
+    }
+    buffered_adapter &operator=(buffered_adapter const &other) {
+        buffered_adapter(other).swap(*this);
+        return *this;
+    }
+    // default destructor
+
+    // Moves everything into one level and returns it, ready for
+    // ordered iteration.  References stay valid until the next insert.
+    adapter_type const &merged() {
+        flush();
+        return levels.back();
+    }
+
+    // Capacity
+    bool empty() const { return size() == 0; }
+    size_type size() const {
+        size_type n = 0;
+        for ( size_type i = 0; i != levels.size(); ++i ) {
+            n += levels[i].size();
+        }
+        return n;
+    }
+    // Extra
+    size_type merge_threshold() const { return threshold; }
+    // Takes effect as the levels next fill up
+    void set_merge_threshold(size_type n) { threshold = n ? n : 1; }
+    size_type level_count() const { return levels.size(); }
+
+    // Modifiers
+    // Returns false if an equivalent element was already present
+    // (only ever for the set_adapter and map_adapter).
+    bool insert(const value_type &v) {
+        detail::key_extractor<key_type, value_type> key_of;
+        if ( unique && contains(key_of(v)) ) return false;
+        levels.front().insert(v);
+        carry(0);
+        return true;
+    }
+#ifdef ASSIST_HAS_CXX11
+    bool insert(value_type &&v) {
+        detail::key_extractor<key_type, value_type> key_of;
+        if ( unique && contains(key_of(v)) ) return false;
+        levels.front().insert(std::move(v));
+        carry(0);
+        return true;
+    }
+#endif
+    // Large batches skip the levels and go straight into the merged
+    // adapter's bulk insert.
+    template <class InputIterator>
+    void insert(InputIterator b, InputIterator const e) {
+        flush();
+        levels.back().insert(b, e);
+    }
+    // Merges every level into the last one
+    void flush() {
+        for ( size_type i = 0; i+1 < levels.size(); ++i ) {
+            if ( !levels[i].empty() ) merge_into_next(i);
+        }
+    }
+    size_type erase(const key_type &k) {
+        size_type n = 0;
+        for ( size_type i = 0; i != levels.size(); ++i ) {
+            typedef typename adapter_type::iterator iterator;
+            std::pair<iterator, iterator> r = levels[i].equal_range(k);
+            n += r.second - r.first;
+            levels[i].erase(r.first, r.second);
+        }
+        return n;
+    }
+    void clear() {
+        levels.erase(levels.begin()+1, levels.end());
+        levels.front().clear();
+    }
+    void swap(buffered_adapter &other) {
+        std::swap( comparator, other.comparator );
+        std::swap( threshold, other.threshold );
+        std::swap( alloc, other.alloc );
+        levels.swap(other.levels);
+    }
+
+    // Observers
+    key_compare key_comp() const { return comparator; }
+    value_compare value_comp() const { return levels.front().value_comp(); }
+    allocator_type get_allocator() const { return alloc; }
+
+    // Set operations
+    size_type count(const key_type &k) const {
+        size_type n = 0;
+        for ( size_type i = 0; i != levels.size(); ++i ) {
+            n += levels[i].count(k);
+        }
+        return n;
+    }
+    bool contains(const key_type &k) const {
+        for ( size_type i = 0; i != levels.size(); ++i ) {
+            if ( !levels[i].empty() && levels[i].contains(k) ) return true;
+        }
+        return false;
+    }
+    // The levels have no common end(), so this returns 0 if k is absent.
+    // For the multi adapters, any one of the equivalent elements.
+    value_type const *find(const key_type &k) const {
+        typedef typename adapter_type::const_iterator const_iterator;
+        for ( size_type i = 0; i != levels.size(); ++i ) {
+            const_iterator const it = levels[i].find(k);
+            if ( it != levels[i].end() ) return &*it;
+        }
+        return 0;
+    }
+};
+
+// Overloaded Algorithms
+template < typename adapter_type >
+void swap(buffered_adapter<adapter_type> &lhs,
+          buffered_adapter<adapter_type> &rhs) {
+    lhs.swap(rhs);
+}
+
+} // namespace assist
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef ASSIST_DETAIL_ADAPTER_TRAITS_HPP
+#define ASSIST_DETAIL_ADAPTER_TRAITS_HPP
+
+/*
+ * assist/detail/adapter_traits.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+#include "../tags.hpp"
+
+namespace assist {
+namespace detail {
+
+// Whether equivalent elements are rejected on insert.
+// The set_adapter and map_adapter specialise this next to themselves.
+template < typename adapter_type >
+struct is_unique_adapter {
+    static bool const value = false;
+};
+
+// The tag for handing an adapter contents that are already in order
+template < typename adapter_type,
+           bool unique = is_unique_adapter<adapter_type>::value >
+struct sorted_tag {
+    typedef sorted_equivalent_t type;
+};
+template < typename adapter_type >
+struct sorted_tag<adapter_type, true> {
+    typedef sorted_unique_t type;
+};
+
+} // namespace detail
+} // namespace assist
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef ASSIST_DETAIL_BATCH_SEARCH_HPP
+#define ASSIST_DETAIL_BATCH_SEARCH_HPP
+
+/*
+ * assist/detail/batch_search.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* lower_bound for a whole batch of keys over one sorted range.
+ * A sorted batch is answered by a single forward sweep that gallops
+ * from the previous answer; anything else is searched group_size keys
+ * at a time, stepping all of the binary searches in lockstep so the
+ * next probe of each can be prefetched while the others compare.
+ * Each answer is handed, in input order, to a visitor f(key, position).
+ */
+
+#include <algorithm> // lower_bound, adjacent_find
+#include <cstddef> // size_t
+
+#include "config.hpp"
+#include "compare.hpp"
+
+namespace assist {
+namespace detail {
+
+// std::lower_bound, but exponential search forward from first,
+// so it costs O(log d) for an answer d elements along.
+template < typename RandomIterator, typename K, typename CMP >
+RandomIterator gallop_lower_bound(RandomIterator const first,
+                                  RandomIterator const last,
+                                  K const &k, CMP cmp) {
+    std::ptrdiff_t const n = last-first;
+    std::ptrdiff_t bound = 1;
+    while ( bound <= n && cmp(first[bound-1], k) ) bound <<= 1;
+    return std::lower_bound(first + bound/2,
+                            first + (bound < n ? bound : n),
+                            k, cmp);
+}
+
+// lower_bound, searching out from hint in whichever direction the
+// answer lies, so it costs O(log d) for an answer d elements from hint.
+template < typename RandomIterator, typename K, typename CMP >
+RandomIterator finger_lower_bound(RandomIterator const first,
+                                  RandomIterator const last,
+                                  RandomIterator const hint,
+                                  K const &k, CMP cmp) {
+    if ( hint == first || cmp(hint[-1], k) ) {
+        return gallop_lower_bound(hint, last, k, cmp);
+    }
+    // the answer is at or before hi
+    RandomIterator hi = hint-1;
+    for ( std::ptrdiff_t step = 1; ; step <<= 1 ) {
+        if ( step > hi-first ) return std::lower_bound(first, hi, k, cmp);
+        RandomIterator const lo = hi-step;
+        if ( cmp(*lo, k) ) return std::lower_bound(lo+1, hi, k, cmp);
+        hi = lo;
+    }
+}
+// upper_bound likewise: the first element that k is less than
+template < typename RandomIterator, typename K, typename CMP >
+RandomIterator finger_upper_bound(RandomIterator const first,
+                                  RandomIterator const last,
+                                  RandomIterator const hint,
+                                  K const &k, CMP cmp) {
+    return finger_lower_bound(first, last, hint, k,
+               negated_compare< reversed_compare<CMP> >(
+                   reversed_compare<CMP>(cmp)));
+}
+
+// Inserts of sorted or nearly sorted input (timestamps, say) land at or
+// near the end, so the adapters check the last few elements before
+// searching everything.
+std::ptrdiff_t const tail_window = 64;
+
+template < typename RandomIterator, typename ForwardIterator,
+           typename CMP, typename Visitor >
+Visitor sweep_lower_bound(RandomIterator first, RandomIterator const last,
+                          ForwardIterator kb, ForwardIterator const ke,
+                          CMP cmp, Visitor f) {
+    for ( ; kb != ke; ++kb ) {
+        // each answer starts the next search
+        first = gallop_lower_bound(first, last, *kb, cmp);
+        f(*kb, first);
+    }
+    return f;
+}
+
+template < typename RandomIterator, typename ForwardIterator,
+           typename CMP, typename Visitor >
+Visitor interleaved_lower_bound(RandomIterator const first,
+                                RandomIterator const last,
+                                ForwardIterator kb, ForwardIterator const ke,
+                                CMP cmp, Visitor f) {
+    std::size_t const group_size = 16;
+    std::size_t const len = last-first;
+    ForwardIterator keys[group_size];
+    std::size_t lo[group_size];
+    while ( kb != ke ) {
+        std::size_t g = 0;
+        for ( ; g != group_size && kb != ke; ++g, ++kb ) {
+            keys[g] = kb;
+            lo[g] = 0;
+        }
+        // every search in the group is over the same length,
+        // so they all take the same number of steps
+        std::size_t n = len;
+        while ( n > 1 ) {
+            std::size_t const half = n/2;
+            std::size_t const next_half = (n-half)/2;
+            for ( std::size_t j = 0; j != g; ++j ) {
+                bool const right = cmp(first[lo[j]+half-1], *keys[j]);
+                lo[j] = right ? lo[j]+half : lo[j];
+                if ( next_half ) ASSIST_PREFETCH(&first[lo[j]+next_half-1]);
+            }
+            n -= half;
+        }
+        for ( std::size_t j = 0; j != g; ++j ) {
+            std::size_t const i = len && cmp(first[lo[j]], *keys[j])
+                                  ? lo[j]+1 : lo[j];
+            f(*keys[j], first+i);
+        }
+    }
+    return f;
+}
+
+// key_cmp orders the keys themselves; cmp compares keys with elements.
+template < typename RandomIterator, typename ForwardIterator,
+           typename KeyCMP, typename CMP, typename Visitor >
+Visitor batch_lower_bound(RandomIterator const first,
+                          RandomIterator const last,
+                          ForwardIterator const kb, ForwardIterator const ke,
+                          KeyCMP key_cmp, CMP cmp, Visitor f) {
+    if ( std::adjacent_find(kb, ke, reversed_compare<KeyCMP>(key_cmp))
+          == ke ) {
+        return sweep_lower_bound(first, last, kb, ke, cmp, f);
+    } else {
+        return interleaved_lower_bound(first, last, kb, ke, cmp, f);
+    }
+}
+
+// Visitors for the adapters' *_many lookups
+
+template < typename OutputIterator >
+struct store_lower_bound {
+    OutputIterator out;
+    store_lower_bound(OutputIterator o) : out(o) {}
+    template < typename K, typename Iterator >
+    void operator()(K const &, Iterator it) { *out++ = it; }
+};
+
+template < typename OutputIterator, typename Iterator, typename CMP >
+struct store_find {
+    OutputIterator out;
+    Iterator end;
+    CMP comparator;
+    store_find(OutputIterator o, Iterator e, CMP cmp)
+     : out(o), end(e), comparator(cmp) {}
+    template < typename K >
+    void operator()(K const &k, Iterator it) {
+        *out++ = ( it == end || comparator(k, *it) ) ? end : it;
+    }
+};
+
+template < typename OutputIterator, typename Iterator, typename CMP >
+struct store_contains {
+    OutputIterator out;
+    Iterator end;
+    CMP comparator;
+    store_contains(OutputIterator o, Iterator e, CMP cmp)
+     : out(o), end(e), comparator(cmp) {}
+    template < typename K >
+    void operator()(K const &k, Iterator it) {
+        *out++ = !( it == end || comparator(k, *it) );
+    }
+};
+
+} // namespace detail
+} // namespace assist
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef ASSIST_DETAIL_COMPACT_HPP
+#define ASSIST_DETAIL_COMPACT_HPP
+
+/*
+ * assist/detail/compact.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* Bulk removal from a sorted range in a single pass, for the adapters'
+ * erase_keys and retain_keys.  Survivors are moved down over the gaps
+ * as they're found, so each element moves at most once, where erasing
+ * the keys one at a time would shift the whole tail for every one.
+ */
+
+#include <vector>
+#include <cstddef> // size_t
+#include <iterator> // iterator_traits
+#include <algorithm> // copy, move, sort, adjacent_find
+
+#include "config.hpp"
+#include "compare.hpp"
+#include "batch_search.hpp"
+
+namespace assist {
+namespace detail {
+
+// !pred(v), for predicates that aren't adaptable
+template < typename Predicate >
+struct negated_predicate {
+    Predicate pred;
+    negated_predicate(Predicate p) : pred(p) {}
+    template < typename T >
+    bool operator()(T const &v) { return !pred(v); }
+};
+
+// Moves [b,e) down to out, unless it's there already, adding to moved
+// how many elements it shifted; returns the end
+template < typename RandomIterator >
+RandomIterator shift_down(RandomIterator b, RandomIterator e,
+                          RandomIterator out, std::size_t &moved) {
+    if ( out == b ) return e;
+    moved += e-b;
+#ifdef ASSIST_HAS_CXX11
+    return std::move(b, e, out);
+#else
+    return std::copy(b, e, out);
+#endif
+}
+
+// Removes from the sorted [first,last) every element equivalent to one
+// of the keys [kb,ke) or, if keep, every element that isn't, keeping
+// the order of the rest; returns their new end, adding to moved how many
+// survivors were shifted down.  A batch in order is swept once,
+// galloping between keys; any other is sorted first.
+template < typename RandomIterator, typename ForwardIterator, typename CMP >
+RandomIterator remove_keys(RandomIterator first, RandomIterator const last,
+                           ForwardIterator kb, ForwardIterator const ke,
+                           CMP cmp, bool keep, std::size_t &moved) {
+    if ( std::adjacent_find(kb, ke, reversed_compare<CMP>(cmp)) != ke ) {
+        typedef typename std::iterator_traits<ForwardIterator>::value_type
+            key_type;
+        std::vector<key_type> sorted(kb, ke);
+        std::sort(sorted.begin(), sorted.end(), cmp);
+        return remove_keys(first, last, sorted.begin(), sorted.end(),
+                           cmp, keep, moved);
+    }
+    RandomIterator out = first;
+    for ( ; kb != ke && first != last; ++kb ) {
+        RandomIterator const lo = gallop_lower_bound(first, last, *kb, cmp);
+        RandomIterator hi = lo;
+        while ( hi != last && !cmp(*kb, *hi) ) ++hi;
+        out = keep ? shift_down(lo, hi, out, moved)
+                   : shift_down(first, lo, out, moved);
+        first = hi;
+    }
+    return keep ? out : shift_down(first, last, out, moved);
+}
+
+} // namespace detail
+} // namespace assist
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef ASSIST_DETAIL_COMPARE_HPP
+#define ASSIST_DETAIL_COMPARE_HPP
+
+/*
+ * assist/detail/compare.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* Comparator wrappers that, unlike std::not2, don't need the
+ * comparator to be adaptable (map_adapter's value_compare isn't).
+ */
+
+namespace assist {
+namespace detail {
+
+// cmp(rhs, lhs)
+template < typename CMP >
+struct reversed_compare {
+    CMP comparator;
+    reversed_compare(CMP cmp) : comparator(cmp) {}
+    template < typename T, typename U >
+    bool operator()(T const &lhs, U const &rhs) const {
+        return comparator(rhs, lhs);
+    }
+};
+
+// !cmp(lhs, rhs); on sorted input, true exactly for equivalent neighbours
+template < typename CMP >
+struct negated_compare {
+    CMP comparator;
+    negated_compare(CMP cmp) : comparator(cmp) {}
+    template < typename T, typename U >
+    bool operator()(T const &lhs, U const &rhs) const {
+        return !comparator(lhs, rhs);
+    }
+};
+
+} // namespace detail
+} // namespace assist
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef ASSIST_DETAIL_CONFIG_HPP
+#define ASSIST_DETAIL_CONFIG_HPP
+
+/*
+ * assist/detail/config.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+// Rvalue references, variadic templates and default template
+// arguments for function templates; without them the adapters
+// offer only their C++98 interface.
+#if __cplusplus >= 201103L || ( defined(_MSC_VER) && _MSC_VER >= 1800 )
+#define ASSIST_HAS_CXX11
+#endif
+
+// Relaxed constexpr (loops and assignment in constexpr functions) and
+// std::index_sequence, for the tables built at compile time.
+#if __cplusplus >= 201402L || ( defined(_MSVC_LANG) && _MSVC_LANG >= 201402L )
+#define ASSIST_HAS_CXX14
+#endif
+
+// std::thread for the parallel construction paths; define
+// ASSIST_NO_THREADS to make those run serially instead.
+#if defined(ASSIST_HAS_CXX11) && !defined(ASSIST_NO_THREADS)
+#define ASSIST_HAS_THREADS
+#endif
+
+// Hint that the cache line holding p will be read soon.
+// Never faults, so p may point past the end of an array.
+#if defined(__GNUC__) || defined(__clang__)
+#define ASSIST_PREFETCH(p) __builtin_prefetch((p))
+#else
+#define ASSIST_PREFETCH(p) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef ASSIST_DETAIL_FILE_MAPPING_HPP
+#define ASSIST_DETAIL_FILE_MAPPING_HPP
+
+/*
+ * assist/detail/file_mapping.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* A whole file mapped read-only into memory, for the views that are
+ * stored on disk.  Copies share the one mapping, which goes away with
+ * the last of them; pages are only read in as they're touched.
+ *
+ * WARNING: Without ASSIST_HAS_CXX11 the sharing count isn't atomic,
+ * so copies of one mapping mustn't be made or dropped concurrently.
+ */
+
+#include <cstddef> // size_t
+#include <string>
+#include <stdexcept> // runtime_error
+
+#include "config.hpp"
+
+#ifdef ASSIST_HAS_CXX11
+#include <atomic>
+#endif
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace assist {
+namespace detail {
+
+class file_mapping {
+    struct state {
+        char const *data;
+        std::size_t length;
+#ifdef ASSIST_HAS_CXX11
+        std::atomic<std::size_t> refs;
+#else
+        std::size_t refs;
+#endif
+    };
+    state *s;
+
+    static void fail(std::string const &what, char const *path) {
+        throw std::runtime_error("assist: cannot " + what + " " + path);
+    }
+    static char const *map(char const *path, std::size_t &length) {
+#ifdef _WIN32
+        HANDLE const file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ,
+                                        0, OPEN_EXISTING,
+                                        FILE_ATTRIBUTE_NORMAL, 0);
+        if ( file == INVALID_HANDLE_VALUE ) fail("open", path);
+        LARGE_INTEGER size;
+        if ( !GetFileSizeEx(file, &size) ) {
+            CloseHandle(file);
+            fail("stat", path);
+        }
+        length = std::size_t(size.QuadPart);
+        if ( length == 0 ) {
+            CloseHandle(file);
+            return 0;
+        }
+        HANDLE const mapping = CreateFileMappingA(file, 0, PAGE_READONLY,
+                                                  0, 0, 0);
+        CloseHandle(file);
+        if ( !mapping ) fail("map", path);
+        void const *p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        // the view keeps the mapping object alive
+        CloseHandle(mapping);
+        if ( !p ) fail("map", path);
+#else
+        int const fd = ::open(path, O_RDONLY);
+        if ( fd == -1 ) fail("open", path);
+        struct stat st;
+        if ( ::fstat(fd, &st) == -1 ) {
+            ::close(fd);
+            fail("stat", path);
+        }
+        length = std::size_t(st.st_size);
+        if ( length == 0 ) {
+            ::close(fd);
+            return 0;
+        }
+        void *p = ::mmap(0, length, PROT_READ, MAP_SHARED, fd, 0);
+        // the mapping keeps the file open
+        ::close(fd);
+        if ( p == MAP_FAILED ) fail("map", path);
+#endif
+        return static_cast<char const *>(p);
+    }
+    void release() {
+        if ( s && --s->refs == 0 ) {
+            if ( s->data ) {
+#ifdef _WIN32
+                UnmapViewOfFile(s->data);
+#else
+                ::munmap(const_cast<char *>(s->data), s->length);
+#endif
+            }
+            delete s;
+        }
+    }
+
+  public:
+    // Construct/Copy/Destroy
+    file_mapping() : s(0) {}
+    // Throws std::runtime_error if path can't be opened and mapped
+    explicit file_mapping(char const *path) : s(new state) {
+        s->refs = 1;
+        try {
+            s->data = map(path, s->length);
+        } catch (...) {
+            delete s;
+            throw;
+        }
+    }
+    file_mapping(file_mapping const &other) : s(other.s) {
+        if ( s ) ++s->refs;
+    }
+    file_mapping &operator=(file_mapping const &other) {
+        file_mapping(other).swap(*this);
+        return *this;
+    }
+    ~file_mapping() { release(); }
+
+    char const *data() const { return s ? s->data : 0; }
+    std::size_t size() const { return s ? s->length : 0; }
+
+    void swap(file_mapping &other) {
+        state *const t = s;
+        s = other.s;
+        other.s = t;
+    }
+};
+
+} // namespace detail
+} // namespace assist
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef ASSIST_DETAIL_FROZEN_HPP
+#define ASSIST_DETAIL_FROZEN_HPP
+
+/*
+ * assist/detail/frozen.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* The constexpr pieces of frozen_set and frozen_map: sorting the
+ * initial elements into order, rejecting duplicates, and searching.
+ *
+ * std::pair can't be assigned in a constant expression before C++20,
+ * so it's a permutation of indices that gets sorted, and the tables
+ * are then built already in order from it.
+ */
+
+#include "config.hpp"
+
+#ifdef ASSIST_HAS_CXX14
+
+#include <utility> // pair
+#include <stdexcept> // invalid_argument
+#include <cstddef> // size_t
+
+namespace assist {
+namespace detail {
+
+struct frozen_identity {
+    template < typename V >
+    constexpr V const &operator()(V const &v) const { return v; }
+};
+struct frozen_first {
+    template < typename K, typename T >
+    constexpr K const &operator()(std::pair<K, T> const &v) const {
+        return v.first;
+    }
+};
+
+// Orders elements by their keys
+template < typename CMP, typename KeyOf >
+struct frozen_less {
+    CMP comparator;
+    constexpr frozen_less(CMP const &cmp) : comparator(cmp) {}
+    template < typename V >
+    constexpr bool operator()(V const &lhs, V const &rhs) const {
+        return comparator(KeyOf()(lhs), KeyOf()(rhs));
+    }
+};
+
+// The elements before lower_bound(k), and before upper_bound(k)
+template < typename CMP, typename KeyOf, typename K >
+struct frozen_before_lower {
+    CMP comparator;
+    K const &k;
+    template < typename V >
+    constexpr bool operator()(V const &v) const {
+        return comparator(KeyOf()(v), k);
+    }
+};
+template < typename CMP, typename KeyOf, typename K >
+struct frozen_before_upper {
+    CMP comparator;
+    K const &k;
+    template < typename V >
+    constexpr bool operator()(V const &v) const {
+        return !comparator(k, KeyOf()(v));
+    }
+};
+
+template < std::size_t N >
+struct index_array {
+    std::size_t i[N];
+    constexpr std::size_t operator[](std::size_t k) const { return i[k]; }
+};
+
+template < typename V, std::size_t N, typename Less >
+constexpr void sift_down(V const (&v)[N], std::size_t (&h)[N],
+                         std::size_t root, std::size_t n, Less less) {
+    for ( ;; ) {
+        std::size_t child = 2*root + 1;
+        if ( child >= n ) return;
+        if ( child+1 < n && less(v[h[child]], v[h[child+1]]) ) ++child;
+        if ( !less(v[h[root]], v[h[child]]) ) return;
+        std::size_t const t = h[root];
+        h[root] = h[child];
+        h[child] = t;
+        root = child;
+    }
+}
+
+// The positions of v's elements in sorted order.  Heapsort, since it
+// needs neither recursion nor much of the compiler's step budget.
+// Equivalent elements throw, which at compile time is an error.
+template < typename V, std::size_t N, typename Less >
+constexpr index_array<N> sorted_order(V const (&v)[N], Less less) {
+    index_array<N> order{};
+    for ( std::size_t k = 0; k != N; ++k ) order.i[k] = k;
+    for ( std::size_t k = N/2; k-- != 0; ) {
+        sift_down(v, order.i, k, N, less);
+    }
+    for ( std::size_t n = N; n > 1; ) {
+        --n;
+        std::size_t const t = order.i[0];
+        order.i[0] = order.i[n];
+        order.i[n] = t;
+        sift_down(v, order.i, 0, n, less);
+    }
+    for ( std::size_t k = 1; k < N; ++k ) {
+        if ( !less(v[order.i[k-1]], v[order.i[k]]) ) {
+            throw std::invalid_argument("assist: duplicate key in frozen table");
+        }
+    }
+    return order;
+}
+
+// The first of the n elements from first for which before is false.
+// Branch-free, and the trip count depends only on n, so with n a
+// constant the compiler can unroll it into a handful of compares.
+template < typename RandomIterator, typename Predicate >
+constexpr RandomIterator fixed_partition_point(RandomIterator first,
+                                               std::size_t n,
+                                               Predicate before) {
+    if ( n == 0 ) return first;
+    while ( n > 1 ) {
+        std::size_t const half = n/2;
+        first += before(first[half-1]) ? half : 0;
+        n -= half;
+    }
+    return first + (before(*first) ? 1 : 0);
+}
+
+} // namespace detail
+} // namespace assist
+
+#endif // ASSIST_HAS_CXX14
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef ASSIST_DETAIL_KEY_EXTRACTOR_HPP
+#define ASSIST_DETAIL_KEY_EXTRACTOR_HPP
+
+/*
+ * assist/detail/key_extractor.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+namespace assist {
+namespace detail {
+
+// Pulls the key out of an adapter's value_type:
+// map-style adapters store pair<key, mapped>, set-style ones the key itself.
+template < typename key_type, typename value_type >
+struct key_extractor {
+    key_type const &operator()(value_type const &v) const { return v.first; }
+};
+template < typename key_type >
+struct key_extractor<key_type, key_type> {
+    key_type const &operator()(key_type const &v) const { return v; }
+};
+
+} // namespace detail
+} // namespace assist
+
+#endif
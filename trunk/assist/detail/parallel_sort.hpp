@@ -0,0 +1,206 @@
+#ifndef ASSIST_DETAIL_PARALLEL_SORT_HPP
+#define ASSIST_DETAIL_PARALLEL_SORT_HPP
+
+/*
+ * assist/detail/parallel_sort.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* Multi-threaded sort and merge behind the adapters' parallel_t paths.
+ * parallel_sort sorts one run per thread, then merges runs pairwise,
+ * ping-ponging through a buffer; every merge is cut into pieces at
+ * matching split points so all threads stay busy up to the last round.
+ * Ties keep the left run's elements first, like std::merge.
+ *
+ * WARNING: A comparator that throws on a worker thread terminates.
+ */
+
+#include <algorithm> // sort, inplace_merge, merge, lower_bound, upper_bound
+#include <vector>
+#include <iterator> // iterator_traits
+#include <cstddef> // size_t
+
+#include "config.hpp"
+
+#ifdef ASSIST_HAS_THREADS
+#include <thread>
+#include <functional> // ref
+#endif
+
+namespace assist {
+namespace detail {
+
+// Below this many elements per thread the threads aren't worth starting
+std::size_t const parallel_grain = 1 << 14;
+
+inline unsigned parallel_threads(unsigned requested, std::size_t n) {
+#ifdef ASSIST_HAS_THREADS
+    unsigned t = requested ? requested : std::thread::hardware_concurrency();
+    if ( n/parallel_grain < t ) t = unsigned(n/parallel_grain);
+    return t ? t : 1;
+#else
+    (void)requested; (void)n;
+    return 1;
+#endif
+}
+
+// Calls each task, all but the first on a thread of their own
+template < typename Task >
+void run_tasks(std::vector<Task> &tasks) {
+    if ( tasks.empty() ) return;
+#ifdef ASSIST_HAS_THREADS
+    std::vector<std::thread> workers;
+    workers.reserve(tasks.size()-1);
+    for ( std::size_t i = 1; i != tasks.size(); ++i ) {
+        workers.push_back(std::thread(std::ref(tasks[i])));
+    }
+    tasks[0]();
+    for ( std::size_t i = 0; i != workers.size(); ++i ) workers[i].join();
+#else
+    for ( std::size_t i = 0; i != tasks.size(); ++i ) tasks[i]();
+#endif
+}
+
+template < typename RandomIterator, typename CMP >
+struct sort_task {
+    RandomIterator b, e;
+    CMP comparator;
+    void operator()() { std::sort(b, e, comparator); }
+};
+
+template < typename InIterator, typename OutIterator, typename CMP >
+struct merge_task {
+    InIterator b1, e1, b2, e2;
+    OutIterator out;
+    CMP comparator;
+    void operator()() { std::merge(b1, e1, b2, e2, out, comparator); }
+};
+
+// Queues the merge of [b1,e1) and [b2,e2) into out as pieces tasks
+template < typename InIterator, typename OutIterator, typename CMP >
+void split_merge(InIterator b1, InIterator const e1,
+                 InIterator b2, InIterator const e2,
+                 OutIterator out, CMP cmp, std::size_t pieces,
+                 std::vector< merge_task<InIterator, OutIterator, CMP> >
+                     &tasks) {
+    InIterator const s1 = b1, s2 = b2;
+    std::size_t const n1 = e1-b1, n2 = e2-b2;
+    for ( std::size_t i = 1; i <= pieces; ++i ) {
+        InIterator m1 = e1, m2 = e2;
+        // cut the longer run evenly, the other where that lands
+        if ( i == pieces ) {
+            // the rest
+        } else if ( n1 >= n2 ) {
+            m1 = s1 + n1*i/pieces;
+            if ( m1 != e1 ) m2 = std::lower_bound(b2, e2, *m1, cmp);
+        } else {
+            m2 = s2 + n2*i/pieces;
+            m1 = std::upper_bound(b1, e1, *m2, cmp);
+        }
+        merge_task<InIterator, OutIterator, CMP> t =
+            { b1, m1, b2, m2, out, cmp };
+        tasks.push_back(t);
+        out += (m1-b1) + (m2-b2);
+        b1 = m1;
+        b2 = m2;
+    }
+}
+
+// Merges neighbouring runs of src (split at bounds) into dst,
+// halving the number of runs.
+template < typename InIterator, typename OutIterator, typename CMP >
+void merge_round(InIterator const src, OutIterator const dst,
+                 std::vector<std::size_t> &bounds, CMP cmp,
+                 unsigned threads) {
+    std::size_t const runs = bounds.size()-1;
+    std::size_t const pairs = runs/2;
+    std::size_t pieces = pairs ? threads/pairs : threads;
+    if ( pieces == 0 ) pieces = 1;
+    std::vector< merge_task<InIterator, OutIterator, CMP> > tasks;
+    std::vector<std::size_t> next;
+    next.push_back(0);
+    for ( std::size_t r = 0; r+1 < runs; r += 2 ) {
+        split_merge(src+bounds[r], src+bounds[r+1],
+                    src+bounds[r+1], src+bounds[r+2],
+                    dst+bounds[r], cmp, pieces, tasks);
+        next.push_back(bounds[r+2]);
+    }
+    if ( runs % 2 ) {
+        // odd run out: a merge with nothing is a copy
+        split_merge(src+bounds[runs-1], src+bounds[runs],
+                    src+bounds[runs], src+bounds[runs],
+                    dst+bounds[runs-1], cmp, pieces, tasks);
+        next.push_back(bounds[runs]);
+    }
+    run_tasks(tasks);
+    bounds.swap(next);
+}
+
+template < typename RandomIterator, typename CMP >
+void parallel_sort(RandomIterator const b, RandomIterator const e,
+                   CMP cmp, unsigned requested) {
+    std::size_t const n = e-b;
+    unsigned const threads = parallel_threads(requested, n);
+    if ( threads == 1 ) {
+        std::sort(b, e, cmp);
+        return;
+    }
+    std::vector<std::size_t> bounds;
+    std::vector< sort_task<RandomIterator, CMP> > sorts;
+    for ( unsigned i = 0; i != threads; ++i ) {
+        bounds.push_back(n*i/threads);
+        sort_task<RandomIterator, CMP> t =
+            { b+n*i/threads, b+n*(i+1)/threads, cmp };
+        sorts.push_back(t);
+    }
+    bounds.push_back(n);
+    run_tasks(sorts);
+
+    typedef typename std::iterator_traits<RandomIterator>::value_type
+        value_type;
+    std::vector<value_type> buffer(b, e);
+    bool in_buffer = false;
+    while ( bounds.size() > 2 ) {
+        if ( in_buffer ) {
+            merge_round(buffer.begin(), b, bounds, cmp, threads);
+        } else {
+            merge_round(b, buffer.begin(), bounds, cmp, threads);
+        }
+        in_buffer = !in_buffer;
+    }
+    if ( in_buffer ) {
+        // one run left, so this is a parallel copy back
+        merge_round(buffer.begin(), b, bounds, cmp, threads);
+    }
+}
+
+// std::inplace_merge(b, m, e, cmp), on several threads
+template < typename RandomIterator, typename CMP >
+void parallel_inplace_merge(RandomIterator const b, RandomIterator const m,
+                            RandomIterator const e, CMP cmp,
+                            unsigned requested) {
+    unsigned const threads = parallel_threads(requested, e-b);
+    if ( threads == 1 ) {
+        std::inplace_merge(b, m, e, cmp);
+        return;
+    }
+    typedef typename std::iterator_traits<RandomIterator>::value_type
+        value_type;
+    std::vector<value_type> buffer(b, e);
+    std::vector< merge_task<typename std::vector<value_type>::iterator,
+                            RandomIterator, CMP> > tasks;
+    split_merge(buffer.begin(), buffer.begin()+(m-b),
+                buffer.begin()+(m-b), buffer.end(),
+                b, cmp, threads, tasks);
+    run_tasks(tasks);
+}
+
+} // namespace detail
+} // namespace assist
+
+#endif
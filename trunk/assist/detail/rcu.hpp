@@ -0,0 +1,114 @@
+#ifndef ASSIST_DETAIL_RCU_HPP
+#define ASSIST_DETAIL_RCU_HPP
+
+/*
+ * assist/detail/rcu.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* The epoch bookkeeping behind rcu_adapter, for anything that publishes
+ * a pointer to readers and frees the old one once they've moved on.
+ * A reader enter()s, announcing the current epoch in a slot of its own,
+ * reads the pointer, and leave()s.  The writer publishes, then
+ * advance()s the epoch; what it retired in epoch e can be freed once
+ * oldest() is past e.
+ */
+
+#include "config.hpp"
+
+#ifdef ASSIST_HAS_CXX11
+
+#include <atomic>
+#include <thread> // this_thread
+#include <functional> // hash
+#include <cstddef> // size_t
+
+namespace assist {
+namespace detail {
+
+// Where a reader announces the epoch it started in; 0 when free.
+// One per cache line, so readers don't contend.
+struct alignas(64) rcu_slot {
+    std::atomic<unsigned long long> epoch;
+    rcu_slot() : epoch(0) {}
+};
+
+std::size_t const rcu_slot_count = 128;
+
+class rcu_epochs {
+    rcu_slot slots[rcu_slot_count];
+    // Readers that found no free slot
+    alignas(64) std::atomic<std::size_t> overflow;
+    std::atomic<unsigned long long> global;
+
+  public:
+    rcu_epochs() : overflow(0), global(1) {}
+    rcu_epochs(rcu_epochs const &) = delete;
+    rcu_epochs &operator=(rcu_epochs const &) = delete;
+
+    // Claims a free slot, announcing the current epoch in it.
+    // After one full pass without finding one, it joins the overflow
+    // readers instead, and returns rcu_slot_count.
+    std::size_t enter() {
+        std::size_t const start =
+            std::hash<std::thread::id>()(std::this_thread::get_id())
+            % rcu_slot_count;
+        for ( std::size_t n = 0; n != rcu_slot_count; ++n ) {
+            std::size_t const i = (start+n) % rcu_slot_count;
+            unsigned long long expected = 0;
+            if ( slots[i].epoch.load(std::memory_order_relaxed) == 0 &&
+                 slots[i].epoch.compare_exchange_strong(expected,
+                     global.load()) ) {
+                return i;
+            }
+        }
+        overflow.fetch_add(1);
+        return rcu_slot_count;
+    }
+    void leave(std::size_t i) {
+        if ( i == rcu_slot_count ) {
+            overflow.fetch_sub(1, std::memory_order_release);
+        } else {
+            slots[i].epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    // Call after publishing; returns the epoch that just ended, in
+    // which the old pointer was retired
+    unsigned long long advance() { return global.fetch_add(1); }
+    // The oldest epoch a reader may still be in: what was retired
+    // before it is free to go.  0 while an overflow reader, which may
+    // hold anything, is reading.
+    unsigned long long oldest() const {
+        if ( overflow.load() ) return 0;
+        unsigned long long r = global.load();
+        for ( std::size_t i = 0; i != rcu_slot_count; ++i ) {
+            unsigned long long const e = slots[i].epoch.load();
+            if ( e && e < r ) r = e;
+        }
+        return r;
+    }
+};
+
+// Holds a slot for the life of a scope
+class rcu_guard {
+    rcu_epochs &epochs;
+    std::size_t const slot;
+  public:
+    explicit rcu_guard(rcu_epochs &e) : epochs(e), slot(e.enter()) {}
+    ~rcu_guard() { epochs.leave(slot); }
+    rcu_guard(rcu_guard const &) = delete;
+    rcu_guard &operator=(rcu_guard const &) = delete;
+};
+
+} // namespace detail
+} // namespace assist
+
+#endif // ASSIST_HAS_CXX11
+
+#endif
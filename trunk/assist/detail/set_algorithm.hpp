@@ -0,0 +1,205 @@
+#ifndef ASSIST_DETAIL_SET_ALGORITHM_HPP
+#define ASSIST_DETAIL_SET_ALGORITHM_HPP
+
+/*
+ * assist/detail/set_algorithm.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* The merges behind assist/set_algorithm.hpp.
+ * The gallop_set_* versions give exactly the std::set_* results,
+ * multiplicities included, but skip over runs with an exponential
+ * search instead of stepping through them, which wins when one range
+ * is much smaller than the other.  set_kernels picks between the two,
+ * and intersects sets of 32-bit integers four against four with SSE2.
+ */
+
+#include <vector>
+#include <algorithm> // set_union, set_intersection, set_difference, copy
+#include <functional> // less
+#include <cstddef> // size_t
+
+#include "config.hpp"
+#include "batch_search.hpp"
+#include "sorted_search.hpp"
+
+namespace assist {
+namespace detail {
+
+// Gallop once one range is this many times longer than the other
+std::size_t const gallop_ratio = 16;
+
+inline bool skewed(std::size_t n1, std::size_t n2) {
+    return n1/gallop_ratio > n2 || n2/gallop_ratio > n1;
+}
+
+template < typename InIterator, typename OutIterator, typename CMP >
+OutIterator gallop_set_union(InIterator b1, InIterator const e1,
+                             InIterator b2, InIterator const e2,
+                             OutIterator out, CMP cmp) {
+    while ( b1 != e1 && b2 != e2 ) {
+        if ( cmp(*b1, *b2) ) {
+            InIterator const m = gallop_lower_bound(b1, e1, *b2, cmp);
+            out = std::copy(b1, m, out);
+            b1 = m;
+        } else if ( cmp(*b2, *b1) ) {
+            InIterator const m = gallop_lower_bound(b2, e2, *b1, cmp);
+            out = std::copy(b2, m, out);
+            b2 = m;
+        } else {
+            *out++ = *b1;
+            ++b1;
+            ++b2;
+        }
+    }
+    out = std::copy(b1, e1, out);
+    return std::copy(b2, e2, out);
+}
+
+template < typename InIterator, typename OutIterator, typename CMP >
+OutIterator gallop_set_intersection(InIterator b1, InIterator const e1,
+                                    InIterator b2, InIterator const e2,
+                                    OutIterator out, CMP cmp) {
+    while ( b1 != e1 && b2 != e2 ) {
+        if ( cmp(*b1, *b2) ) {
+            b1 = gallop_lower_bound(b1, e1, *b2, cmp);
+        } else if ( cmp(*b2, *b1) ) {
+            b2 = gallop_lower_bound(b2, e2, *b1, cmp);
+        } else {
+            *out++ = *b1;
+            ++b1;
+            ++b2;
+        }
+    }
+    return out;
+}
+
+template < typename InIterator, typename OutIterator, typename CMP >
+OutIterator gallop_set_difference(InIterator b1, InIterator const e1,
+                                  InIterator b2, InIterator const e2,
+                                  OutIterator out, CMP cmp) {
+    while ( b1 != e1 && b2 != e2 ) {
+        if ( cmp(*b1, *b2) ) {
+            InIterator const m = gallop_lower_bound(b1, e1, *b2, cmp);
+            out = std::copy(b1, m, out);
+            b1 = m;
+        } else if ( cmp(*b2, *b1) ) {
+            b2 = gallop_lower_bound(b2, e2, *b1, cmp);
+        } else {
+            ++b1;
+            ++b2;
+        }
+    }
+    return std::copy(b1, e1, out);
+}
+
+// Intersection of two strictly increasing arrays of 32-bit integers:
+// each block of four is compared against all four rotations of the
+// other block, and whichever block ends lower moves on.
+template < typename T, bool Enabled = simd_key_traits<T>::enabled,
+           std::size_t Size = sizeof(T) >
+struct simd_intersect {
+    template < typename OutIterator >
+    static OutIterator apply(T const *p1, std::size_t n1,
+                             T const *p2, std::size_t n2,
+                             OutIterator out) {
+        return std::set_intersection(p1, p1+n1, p2, p2+n2, out);
+    }
+};
+#if defined(__SSE2__) || defined(_M_X64)
+template < typename T >
+struct simd_intersect<T, true, 4> {
+    template < typename OutIterator >
+    static OutIterator apply(T const *p1, std::size_t n1,
+                             T const *p2, std::size_t n2,
+                             OutIterator out) {
+        std::size_t i = 0, j = 0;
+        while ( i+4 <= n1 && j+4 <= n2 ) {
+            __m128i const v1 = _mm_loadu_si128(
+                                   reinterpret_cast<__m128i const *>(p1+i));
+            __m128i v2 = _mm_loadu_si128(
+                             reinterpret_cast<__m128i const *>(p2+j));
+            __m128i m = _mm_cmpeq_epi32(v1, v2);
+            v2 = _mm_shuffle_epi32(v2, _MM_SHUFFLE(0,3,2,1));
+            m = _mm_or_si128(m, _mm_cmpeq_epi32(v1, v2));
+            v2 = _mm_shuffle_epi32(v2, _MM_SHUFFLE(0,3,2,1));
+            m = _mm_or_si128(m, _mm_cmpeq_epi32(v1, v2));
+            v2 = _mm_shuffle_epi32(v2, _MM_SHUFFLE(0,3,2,1));
+            m = _mm_or_si128(m, _mm_cmpeq_epi32(v1, v2));
+            for ( unsigned mask = _mm_movemask_ps(_mm_castsi128_ps(m));
+                  mask; mask &= mask-1 ) {
+                *out++ = p1[i + count_trailing_zeros(mask)];
+            }
+            T const last1 = p1[i+3], last2 = p2[j+3];
+            i += last1 < last2 || last1 == last2 ? 4 : 0;
+            j += last2 < last1 || last1 == last2 ? 4 : 0;
+        }
+        return std::set_intersection(p1+i, p1+n1, p2+j, p2+n2, out);
+    }
+};
+#endif
+
+// The merges over the contents of base_types ordered by CMP;
+// unique is true if neither holds equivalent elements.
+template < typename base_type, typename CMP, bool unique >
+struct set_kernels {
+    template < typename InIterator, typename OutIterator >
+    static OutIterator set_union(InIterator b1, InIterator e1,
+                                 InIterator b2, InIterator e2,
+                                 OutIterator out, CMP const &cmp) {
+        if ( skewed(e1-b1, e2-b2) ) {
+            return gallop_set_union(b1, e1, b2, e2, out, cmp);
+        }
+        return std::set_union(b1, e1, b2, e2, out, cmp);
+    }
+    template < typename InIterator, typename OutIterator >
+    static OutIterator set_intersection(InIterator b1, InIterator e1,
+                                        InIterator b2, InIterator e2,
+                                        OutIterator out, CMP const &cmp) {
+        if ( skewed(e1-b1, e2-b2) ) {
+            return gallop_set_intersection(b1, e1, b2, e2, out, cmp);
+        }
+        return std::set_intersection(b1, e1, b2, e2, out, cmp);
+    }
+    template < typename InIterator, typename OutIterator >
+    static OutIterator set_difference(InIterator b1, InIterator e1,
+                                      InIterator b2, InIterator e2,
+                                      OutIterator out, CMP const &cmp) {
+        if ( skewed(e1-b1, e2-b2) ) {
+            return gallop_set_difference(b1, e1, b2, e2, out, cmp);
+        }
+        return std::set_difference(b1, e1, b2, e2, out, cmp);
+    }
+    template < typename InIterator, typename OutIterator >
+    static OutIterator set_symmetric_difference(InIterator b1, InIterator e1,
+                                                InIterator b2, InIterator e2,
+                                                OutIterator out,
+                                                CMP const &cmp) {
+        return std::set_symmetric_difference(b1, e1, b2, e2, out, cmp);
+    }
+};
+template < typename T, typename A >
+struct set_kernels< std::vector<T, A>, std::less<T>, true >
+ : set_kernels< std::vector<T, A>, std::less<T>, false > {
+    template < typename InIterator, typename OutIterator >
+    static OutIterator set_intersection(InIterator b1, InIterator e1,
+                                        InIterator b2, InIterator e2,
+                                        OutIterator out,
+                                        std::less<T> const &cmp) {
+        if ( skewed(e1-b1, e2-b2) ) {
+            return gallop_set_intersection(b1, e1, b2, e2, out, cmp);
+        }
+        if ( b1 == e1 || b2 == e2 ) return out;
+        return simd_intersect<T>::apply(&*b1, e1-b1, &*b2, e2-b2, out);
+    }
+};
+
+} // namespace detail
+} // namespace assist
+
+#endif
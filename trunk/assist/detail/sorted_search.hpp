@@ -0,0 +1,262 @@
+#ifndef ASSIST_DETAIL_SORTED_SEARCH_HPP
+#define ASSIST_DETAIL_SORTED_SEARCH_HPP
+
+/*
+ * assist/detail/sorted_search.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* The binary searches behind the sorted adapters.
+ * sorted_search<base_type, CMP> forwards to the std algorithms, except
+ * for a std::vector of 32- or 64-bit integers ordered by std::less,
+ * where a branchless binary search narrows the range to a cache line
+ * and a vectorised count of the smaller elements finishes it off.
+ * The instruction set is picked at compile time (AVX2, SSE4.2, SSE2);
+ * without any of them the final count is a plain loop.
+ */
+
+#include <vector>
+#include <utility> // pair
+#include <algorithm> // lower_bound, upper_bound, equal_range, binary_search
+#include <functional> // less
+#include <cstddef> // size_t
+
+#include "config.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace assist {
+namespace detail {
+
+inline unsigned popcount(unsigned x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcount(x);
+#else
+    unsigned n = 0;
+    for ( ; x; x &= x-1 ) ++n;
+    return n;
+#endif
+}
+
+// x must not be 0
+inline unsigned count_trailing_zeros(unsigned x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(x);
+#else
+    unsigned n = 0;
+    for ( ; !(x & 1); x >>= 1 ) ++n;
+    return n;
+#endif
+}
+
+// Which keys get the vectorised kernel
+template <typename T>
+struct simd_key_traits {
+    static bool const enabled = false;
+};
+#define ASSIST_DETAIL_DEFINE_SIMD_KEY_TRAITS(T, S) \
+template <> \
+struct simd_key_traits<T> { \
+    static bool const enabled = sizeof(T) == 4 || sizeof(T) == 8; \
+    static bool const is_signed = S; \
+}
+ASSIST_DETAIL_DEFINE_SIMD_KEY_TRAITS(   signed int, true );
+ASSIST_DETAIL_DEFINE_SIMD_KEY_TRAITS( unsigned int, false );
+ASSIST_DETAIL_DEFINE_SIMD_KEY_TRAITS(   signed long, true );
+ASSIST_DETAIL_DEFINE_SIMD_KEY_TRAITS( unsigned long, false );
+ASSIST_DETAIL_DEFINE_SIMD_KEY_TRAITS(   signed long long, true );
+ASSIST_DETAIL_DEFINE_SIMD_KEY_TRAITS( unsigned long long, false );
+#undef ASSIST_DETAIL_DEFINE_SIMD_KEY_TRAITS
+
+// Counts the elements of p[0,n) that are less than k (or, if
+// or_equal, not greater than k).  Only ever called with n no bigger
+// than a cache line's worth, so the scalar tail stays short.
+template < typename T, std::size_t Size = sizeof(T) >
+struct simd_count {
+    static std::size_t less(T const *p, std::size_t n, T k, bool or_equal) {
+        std::size_t c = 0;
+        if ( or_equal ) {
+            for ( std::size_t i = 0; i != n; ++i ) c += !(k < p[i]);
+        } else {
+            for ( std::size_t i = 0; i != n; ++i ) c += p[i] < k;
+        }
+        return c;
+    }
+};
+
+#if defined(__SSE2__) || defined(_M_X64)
+template < typename T >
+struct simd_count<T, 4> {
+    static std::size_t less(T const *p, std::size_t n, T k, bool or_equal) {
+        int const flip = simd_key_traits<T>::is_signed ? 0 : int(0x80000000u);
+        int const key = int(k) ^ flip;
+        std::size_t greater = 0, i = 0;
+#if defined(__AVX2__)
+        __m256i const kv8 = _mm256_set1_epi32(key);
+        __m256i const fv8 = _mm256_set1_epi32(flip);
+        for ( ; i+8 <= n; i += 8 ) {
+            __m256i v = _mm256_loadu_si256(
+                            reinterpret_cast<__m256i const *>(p+i));
+            v = _mm256_xor_si256(v, fv8);
+            __m256i const m = or_equal ? _mm256_cmpgt_epi32(v, kv8)
+                                       : _mm256_cmpgt_epi32(kv8, v);
+            greater += popcount(_mm256_movemask_ps(_mm256_castsi256_ps(m)));
+        }
+#endif
+        __m128i const kv = _mm_set1_epi32(key);
+        __m128i const fv = _mm_set1_epi32(flip);
+        for ( ; i+4 <= n; i += 4 ) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p+i));
+            v = _mm_xor_si128(v, fv);
+            __m128i const m = or_equal ? _mm_cmpgt_epi32(v, kv)
+                                       : _mm_cmpgt_epi32(kv, v);
+            greater += popcount(_mm_movemask_ps(_mm_castsi128_ps(m)));
+        }
+        // greater counts the elements > k when or_equal, < k otherwise
+        std::size_t c = or_equal ? i - greater : greater;
+        return c + simd_count<T, 0>::less(p+i, n-i, k, or_equal);
+    }
+};
+#endif
+
+#if defined(__SSE4_2__)
+template < typename T >
+struct simd_count<T, 8> {
+    static std::size_t less(T const *p, std::size_t n, T k, bool or_equal) {
+        typedef long long ll;
+        ll const flip = simd_key_traits<T>::is_signed ? 0 : ll(1) << 63;
+        ll const key = ll(k) ^ flip;
+        std::size_t greater = 0, i = 0;
+#if defined(__AVX2__)
+        __m256i const kv4 = _mm256_set1_epi64x(key);
+        __m256i const fv4 = _mm256_set1_epi64x(flip);
+        for ( ; i+4 <= n; i += 4 ) {
+            __m256i v = _mm256_loadu_si256(
+                            reinterpret_cast<__m256i const *>(p+i));
+            v = _mm256_xor_si256(v, fv4);
+            __m256i const m = or_equal ? _mm256_cmpgt_epi64(v, kv4)
+                                       : _mm256_cmpgt_epi64(kv4, v);
+            greater += popcount(_mm256_movemask_pd(_mm256_castsi256_pd(m)));
+        }
+#endif
+        __m128i const kv = _mm_set1_epi64x(key);
+        __m128i const fv = _mm_set1_epi64x(flip);
+        for ( ; i+2 <= n; i += 2 ) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p+i));
+            v = _mm_xor_si128(v, fv);
+            __m128i const m = or_equal ? _mm_cmpgt_epi64(v, kv)
+                                       : _mm_cmpgt_epi64(kv, v);
+            greater += popcount(_mm_movemask_pd(_mm_castsi128_pd(m)));
+        }
+        std::size_t c = or_equal ? i - greater : greater;
+        return c + simd_count<T, 0>::less(p+i, n-i, k, or_equal);
+    }
+};
+#endif
+
+// Index of the first element of the sorted p[0,n) not less than
+// (or, if upper, greater than) k.
+template < typename T >
+std::size_t simd_bound(T const *p, std::size_t n, T k, bool upper) {
+    std::size_t const window = 64/sizeof(T);
+    std::size_t lo = 0;
+    // answer is always in [lo, lo+n]
+    while ( n > window ) {
+        std::size_t const half = n/2;
+        ASSIST_PREFETCH(p + lo + half/2);
+        ASSIST_PREFETCH(p + lo + half + half/2);
+        T const &probe = p[lo+half-1];
+        bool const right = upper ? !(k < probe) : probe < k;
+        lo = right ? lo+half : lo;
+        n -= half;
+    }
+    return lo + simd_count<T>::less(p+lo, n, k, upper);
+}
+
+template < typename T, bool Enabled = simd_key_traits<T>::enabled >
+struct simd_search {
+    template < typename It, typename K >
+    static It lower_bound(It b, It e, K const &k, std::less<T> const &cmp) {
+        return std::lower_bound(b, e, k, cmp);
+    }
+    template < typename It, typename K >
+    static It upper_bound(It b, It e, K const &k, std::less<T> const &cmp) {
+        return std::upper_bound(b, e, k, cmp);
+    }
+    template < typename It, typename K >
+    static std::pair<It, It> equal_range(It b, It e, K const &k,
+                                         std::less<T> const &cmp) {
+        return std::equal_range(b, e, k, cmp);
+    }
+    template < typename It, typename K >
+    static bool binary_search(It b, It e, K const &k,
+                              std::less<T> const &cmp) {
+        return std::binary_search(b, e, k, cmp);
+    }
+};
+template < typename T >
+struct simd_search<T, true> {
+    template < typename It >
+    static It lower_bound(It b, It e, T const &k, std::less<T> const &) {
+        if ( b == e ) return b;
+        return b + simd_bound(&*b, e-b, k, false);
+    }
+    template < typename It >
+    static It upper_bound(It b, It e, T const &k, std::less<T> const &) {
+        if ( b == e ) return b;
+        return b + simd_bound(&*b, e-b, k, true);
+    }
+    template < typename It >
+    static std::pair<It, It> equal_range(It b, It e, T const &k,
+                                         std::less<T> const &cmp) {
+        It const first = lower_bound(b, e, k, cmp);
+        return std::make_pair(first, upper_bound(first, e, k, cmp));
+    }
+    template < typename It >
+    static bool binary_search(It b, It e, T const &k,
+                              std::less<T> const &cmp) {
+        It const it = lower_bound(b, e, k, cmp);
+        return it != e && !(k < *it);
+    }
+};
+
+// Searches over the contents of a base_type ordered by CMP
+template < typename base_type, typename CMP >
+struct sorted_search {
+    template < typename It, typename K >
+    static It lower_bound(It b, It e, K const &k, CMP const &cmp) {
+        return std::lower_bound(b, e, k, cmp);
+    }
+    template < typename It, typename K >
+    static It upper_bound(It b, It e, K const &k, CMP const &cmp) {
+        return std::upper_bound(b, e, k, cmp);
+    }
+    template < typename It, typename K >
+    static std::pair<It, It> equal_range(It b, It e, K const &k,
+                                         CMP const &cmp) {
+        return std::equal_range(b, e, k, cmp);
+    }
+    template < typename It, typename K >
+    static bool binary_search(It b, It e, K const &k, CMP const &cmp) {
+        return std::binary_search(b, e, k, cmp);
+    }
+};
+template < typename T, typename A >
+struct sorted_search< std::vector<T, A>, std::less<T> >
+ : simd_search<T> {};
+
+} // namespace detail
+} // namespace assist
+
+#endif
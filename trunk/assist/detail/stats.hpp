@@ -0,0 +1,110 @@
+#ifndef ASSIST_DETAIL_STATS_HPP
+#define ASSIST_DETAIL_STATS_HPP
+
+/*
+ * assist/detail/stats.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* How the adapters feed their statistics policy.  Everything here is
+ * specialised for no_stats into nothing, so that the default adapters
+ * keep their size, their vectorised searches and their code.
+ */
+
+#include <cstddef> // size_t
+
+#include "../stats.hpp"
+
+namespace assist {
+namespace detail {
+
+// Holds an adapter's counters, as a base so no_stats takes no room.
+// Lookups are const, so the counters are mutable.
+template < typename Stats >
+class stats_holder {
+    mutable Stats counts;
+  protected:
+    Stats &counters() const { return counts; }
+};
+template <>
+class stats_holder<no_stats> : no_stats {
+  protected:
+    // no_stats has no state to change
+    no_stats &counters() const {
+        return const_cast<stats_holder &>(*this);
+    }
+};
+
+// cmp, reporting each call
+template < typename CMP, typename Stats >
+struct counting_compare {
+    CMP comparator;
+    Stats *counters;
+    counting_compare(CMP const &cmp, Stats &s)
+     : comparator(cmp), counters(&s) {}
+    template < typename T, typename U >
+    bool operator()(T const &lhs, U const &rhs) const {
+        counters->on_compare();
+        return comparator(lhs, rhs);
+    }
+};
+
+// The comparator an adapter searches, sorts and merges with
+template < typename CMP, typename Stats >
+struct stats_compare {
+    typedef counting_compare<CMP, Stats> type;
+    static type get(CMP const &cmp, Stats &s) { return type(cmp, s); }
+};
+template < typename CMP >
+struct stats_compare<CMP, no_stats> {
+    typedef CMP type;
+    static CMP const &get(CMP const &cmp, no_stats &) { return cmp; }
+};
+
+// Reports the comparisons between construction and destruction
+// as one lookup
+template < typename Stats >
+class lookup_probe {
+    Stats &counters;
+    std::size_t const start;
+  public:
+    explicit lookup_probe(Stats &s)
+     : counters(s), start(s.compare_count()) {}
+    ~lookup_probe() {
+        counters.on_lookup(counters.compare_count() - start);
+    }
+};
+template <>
+class lookup_probe<no_stats> {
+  public:
+    explicit lookup_probe(no_stats &) {}
+};
+
+// Reports whether c reallocated between construction and destruction
+template < typename Stats, typename Container >
+class growth_probe {
+    Stats &counters;
+    Container const &c;
+    typename Container::size_type const start;
+  public:
+    growth_probe(Stats &s, Container const &b)
+     : counters(s), c(b), start(b.capacity()) {}
+    ~growth_probe() {
+        if ( c.capacity() != start ) counters.on_reallocate();
+    }
+};
+template < typename Container >
+class growth_probe<no_stats, Container> {
+  public:
+    growth_probe(no_stats &, Container const &) {}
+};
+
+} // namespace detail
+} // namespace assist
+
+#endif
@@ -0,0 +1,713 @@
+#ifndef ASSIST_DETAIL_TRIE_NODE_HPP
+#define ASSIST_DETAIL_TRIE_NODE_HPP
+
+/*
+ * assist/detail/trie_node.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* The nodes of trie, an adaptive radix tree: each inner node branches
+ * on one byte of the key, and comes in four sizes so that its children
+ * take little more room than they need.
+ *
+ *   node4, node16  up to 4 or 16 children, with their bytes in order
+ *                  beside them, searched linearly (node16 with one
+ *                  SSE2 compare where there is one)
+ *   node48         a 256-entry byte index into up to 48 children
+ *   node256        a child for every byte
+ *
+ * Nodes grow into the next size when full, and shrink back a size when
+ * erasing leaves them well under half full.  Runs of bytes without a
+ * branch are collapsed into the prefix of the node below them.  A key
+ * that ends at an inner node, being a prefix of longer ones, hangs off
+ * its value rather than a child.
+ *
+ * Nodes don't come from the heap one at a time.  Each kind, leaves
+ * included, has a pool of fixed-size slots, in chunks that never move,
+ * with a free list of its own; a node is named by a 32-bit trie_ref
+ * holding its kind and its slot.  Nothing points up the tree: iterators
+ * keep the way down on a stack.  Inner nodes hold only bytes and refs,
+ * so copying a trie copies their pools a chunk at a time, and
+ * destroying it frees the chunks, with only the leaves visited to copy
+ * or destroy their values.
+ */
+
+#include <vector>
+#include <iterator> // forward_iterator_tag
+#include <algorithm> // min, swap
+#include <new> // operator new, placement new, bad_alloc
+#include <cstring> // memcpy, memmove, memset
+#include <cstddef> // size_t, ptrdiff_t
+
+#include "config.hpp"
+#include "sorted_search.hpp" // count_trailing_zeros
+#include "../small_vector.hpp"
+
+#ifdef ASSIST_HAS_CXX11
+#include <type_traits> // is_trivially_destructible
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace assist {
+namespace detail {
+
+enum trie_kind {
+    trie_leaf_kind,
+    trie_node4_kind,
+    trie_node16_kind,
+    trie_node48_kind,
+    trie_node256_kind
+};
+
+// The kind in the low bits, and one more than the slot above them,
+// so that 0 is no node at all
+typedef unsigned int trie_ref;
+unsigned const trie_kind_bits = 3;
+// The most nodes of any one kind
+std::size_t const trie_max_nodes = ( 1u << ( 32 - trie_kind_bits ) ) - 1;
+
+inline trie_ref make_trie_ref(trie_kind k, std::size_t slot) {
+    return trie_ref( ( slot+1 ) << trie_kind_bits | k );
+}
+inline trie_kind ref_kind(trie_ref r) {
+    return trie_kind( r & ( ( 1u << trie_kind_bits ) - 1 ) );
+}
+inline std::size_t ref_slot(trie_ref r) {
+    return ( r >> trie_kind_bits ) - 1;
+}
+inline bool is_trie_leaf(trie_ref r) {
+    return ref_kind(r) == trie_leaf_kind;
+}
+
+// A prefix longer than this keeps only its first bytes in the node;
+// the rest are read back from a leaf below it when needed.
+std::size_t const trie_prefix_bytes = 8;
+
+struct trie_inner {
+    unsigned char kind;
+    unsigned short count;
+    unsigned int prefix_len;
+    unsigned char prefix[trie_prefix_bytes];
+    // the leaf whose key ends here, if any
+    trie_ref value;
+    explicit trie_inner(trie_kind k)
+     : kind(k), count(0), prefix_len(0), value(0) {}
+};
+
+struct trie_node4 : trie_inner {
+    unsigned char keys[4];
+    trie_ref children[4];
+    trie_node4() : trie_inner(trie_node4_kind) {}
+};
+struct trie_node16 : trie_inner {
+    unsigned char keys[16];
+    trie_ref children[16];
+    trie_node16() : trie_inner(trie_node16_kind) {
+        // find_child reads all of keys
+        std::memset(keys, 0, sizeof keys);
+    }
+};
+struct trie_node48 : trie_inner {
+    // one more than the slot of each byte's child, or 0
+    unsigned char index[256];
+    trie_ref children[48];
+    trie_node48() : trie_inner(trie_node48_kind) {
+        std::memset(index, 0, sizeof index);
+        std::memset(children, 0, sizeof children);
+    }
+};
+struct trie_node256 : trie_inner {
+    trie_ref children[256];
+    trie_node256() : trie_inner(trie_node256_kind) {
+        std::memset(children, 0, sizeof children);
+    }
+};
+
+// Children are found by position: the index into keys for node4 and
+// node16, the byte itself for node48 and node256.  Positions go up in
+// the order of the bytes.
+
+// The position of byte b's child, or -1
+inline int find_child(trie_inner const *n, unsigned char b) {
+    switch ( n->kind ) {
+      case trie_node4_kind: {
+        trie_node4 const *p = static_cast<trie_node4 const *>(n);
+        for ( int i = 0; i != p->count; ++i ) {
+            if ( p->keys[i] == b ) return i;
+        }
+        return -1;
+      }
+      case trie_node16_kind: {
+        trie_node16 const *p = static_cast<trie_node16 const *>(n);
+#if defined(__SSE2__) || defined(_M_X64)
+        // all 16 bytes at once; those past count are masked off
+        __m128i const v = _mm_loadu_si128(
+                              reinterpret_cast<__m128i const *>(p->keys));
+        unsigned const m = _mm_movemask_epi8(
+                               _mm_cmpeq_epi8(v, _mm_set1_epi8(char(b))))
+                         & ( ( 1u << p->count ) - 1 );
+        return m ? int(count_trailing_zeros(m)) : -1;
+#else
+        for ( int i = 0; i != p->count; ++i ) {
+            if ( p->keys[i] == b ) return i;
+        }
+        return -1;
+#endif
+      }
+      case trie_node48_kind:
+        return static_cast<trie_node48 const *>(n)->index[b] ? b : -1;
+      default:
+        return static_cast<trie_node256 const *>(n)->children[b] ? b : -1;
+    }
+}
+
+inline trie_ref &child_at(trie_inner *n, int pos) {
+    switch ( n->kind ) {
+      case trie_node4_kind:
+        return static_cast<trie_node4 *>(n)->children[pos];
+      case trie_node16_kind:
+        return static_cast<trie_node16 *>(n)->children[pos];
+      case trie_node48_kind: {
+        trie_node48 *p = static_cast<trie_node48 *>(n);
+        return p->children[p->index[pos]-1];
+      }
+      default:
+        return static_cast<trie_node256 *>(n)->children[pos];
+    }
+}
+inline trie_ref child_at(trie_inner const *n, int pos) {
+    return child_at(const_cast<trie_inner *>(n), pos);
+}
+
+// The byte the child at pos hangs off
+inline unsigned char byte_at(trie_inner const *n, int pos) {
+    switch ( n->kind ) {
+      case trie_node4_kind:
+        return static_cast<trie_node4 const *>(n)->keys[pos];
+      case trie_node16_kind:
+        return static_cast<trie_node16 const *>(n)->keys[pos];
+      default:
+        return static_cast<unsigned char>(pos);
+    }
+}
+
+// The first position from pos on that holds a child, or -1
+inline int next_child(trie_inner const *n, int pos) {
+    switch ( n->kind ) {
+      case trie_node4_kind:
+      case trie_node16_kind:
+        return pos < n->count ? pos : -1;
+      case trie_node48_kind: {
+        trie_node48 const *p = static_cast<trie_node48 const *>(n);
+        for ( ; pos < 256; ++pos ) {
+            if ( p->index[pos] ) return pos;
+        }
+        return -1;
+      }
+      default: {
+        trie_node256 const *p = static_cast<trie_node256 const *>(n);
+        for ( ; pos < 256; ++pos ) {
+            if ( p->children[pos] ) return pos;
+        }
+        return -1;
+      }
+    }
+}
+
+inline bool is_full(trie_inner const *n) {
+    switch ( n->kind ) {
+      case trie_node4_kind: return n->count == 4;
+      case trie_node16_kind: return n->count == 16;
+      case trie_node48_kind: return n->count == 48;
+      default: return false;
+    }
+}
+
+// Room in a sorted keys/children pair for byte b, shifting up the rest
+template < std::size_t N >
+void sorted_add_child(unsigned char (&keys)[N], trie_ref (&children)[N],
+                      unsigned count, unsigned char b, trie_ref child) {
+    unsigned i = 0;
+    while ( i != count && keys[i] < b ) ++i;
+    std::memmove(keys+i+1, keys+i, count-i);
+    std::memmove(children+i+1, children+i, (count-i) * sizeof(trie_ref));
+    keys[i] = b;
+    children[i] = child;
+}
+
+// n must not be full, nor have a child for b already
+inline void add_child(trie_inner *n, unsigned char b, trie_ref child) {
+    switch ( n->kind ) {
+      case trie_node4_kind: {
+        trie_node4 *p = static_cast<trie_node4 *>(n);
+        sorted_add_child(p->keys, p->children, p->count, b, child);
+        break;
+      }
+      case trie_node16_kind: {
+        trie_node16 *p = static_cast<trie_node16 *>(n);
+        sorted_add_child(p->keys, p->children, p->count, b, child);
+        break;
+      }
+      case trie_node48_kind: {
+        trie_node48 *p = static_cast<trie_node48 *>(n);
+        int slot = 0;
+        while ( p->children[slot] ) ++slot;
+        p->children[slot] = child;
+        p->index[b] = static_cast<unsigned char>(slot + 1);
+        break;
+      }
+      default:
+        static_cast<trie_node256 *>(n)->children[b] = child;
+    }
+    ++n->count;
+}
+
+inline void remove_child(trie_inner *n, int pos) {
+    switch ( n->kind ) {
+      case trie_node4_kind: {
+        trie_node4 *p = static_cast<trie_node4 *>(n);
+        std::memmove(p->keys+pos, p->keys+pos+1, p->count-pos-1);
+        std::memmove(p->children+pos, p->children+pos+1,
+                     (p->count-pos-1) * sizeof(trie_ref));
+        break;
+      }
+      case trie_node16_kind: {
+        trie_node16 *p = static_cast<trie_node16 *>(n);
+        std::memmove(p->keys+pos, p->keys+pos+1, p->count-pos-1);
+        std::memmove(p->children+pos, p->children+pos+1,
+                     (p->count-pos-1) * sizeof(trie_ref));
+        break;
+      }
+      case trie_node48_kind: {
+        trie_node48 *p = static_cast<trie_node48 *>(n);
+        p->children[p->index[pos]-1] = 0;
+        p->index[pos] = 0;
+        break;
+      }
+      default:
+        static_cast<trie_node256 *>(n)->children[pos] = 0;
+    }
+    --n->count;
+}
+
+// Slots of one size, in chunks that never move, so that pointers to
+// what's in them stay good however many more are handed out.  A free
+// slot holds the next free one in its first bytes.
+class trie_pool {
+    std::vector<char *> chunks;
+    std::size_t slot_size;
+    // each chunk has 1 << shift slots
+    unsigned shift;
+    // slots handed out at some time, free or not
+    std::size_t used;
+    // one more than the first free slot, or 0
+    trie_ref free_head;
+
+    // non-copyable
+    trie_pool(trie_pool const &);
+    trie_pool &operator=(trie_pool const &);
+
+    std::size_t chunk_bytes() const { return slot_size << shift; }
+
+  public:
+    // Construct/Copy/Destroy
+    explicit trie_pool(std::size_t object_size)
+     : slot_size(object_size < sizeof(trie_ref) ? sizeof(trie_ref)
+                                                : object_size),
+       shift(0), used(0), free_head(0) {
+        // chunks of about 16kB, or of one slot if that's bigger
+        while ( shift != 12 && ( slot_size << ( shift+1 ) ) <= 16384 ) {
+            ++shift;
+        }
+    }
+    ~trie_pool() { release(); }
+
+    void *operator[](std::size_t i) const {
+        return chunks[i >> shift]
+             + ( i & ( ( std::size_t(1) << shift ) - 1 ) ) * slot_size;
+    }
+
+    std::size_t allocate() {
+        if ( free_head ) {
+            std::size_t const i = free_head - 1;
+            std::memcpy(&free_head, (*this)[i], sizeof free_head);
+            return i;
+        }
+        if ( used == trie_max_nodes ) throw std::bad_alloc();
+        if ( ( used >> shift ) == chunks.size() ) {
+            chunks.reserve(chunks.size() + 1);
+            chunks.push_back(static_cast<char *>(
+                                 ::operator new(chunk_bytes())));
+        }
+        return used++;
+    }
+    void deallocate(std::size_t i) {
+        std::memcpy((*this)[i], &free_head, sizeof free_head);
+        free_head = trie_ref(i + 1);
+    }
+    // Every slot is gone, without being destroyed
+    void release() {
+        for ( std::size_t c = 0; c != chunks.size(); ++c ) {
+            ::operator delete(chunks[c]);
+        }
+        chunks.clear();
+        used = 0;
+        free_head = 0;
+    }
+    // other's slots, byte for byte, at the same places; only right for
+    // what can be copied that way
+    void assign(trie_pool const &other) {
+        release();
+        chunks.reserve(other.chunks.size());
+        for ( std::size_t c = 0; c != other.chunks.size(); ++c ) {
+            char *const chunk = static_cast<char *>(
+                                    ::operator new(chunk_bytes()));
+            chunks.push_back(chunk);
+            std::size_t const first = c << shift;
+            std::size_t const n = std::min<std::size_t>(
+                                      other.used - first,
+                                      std::size_t(1) << shift);
+            std::memcpy(chunk, other.chunks[c], n * slot_size);
+        }
+        used = other.used;
+        free_head = other.free_head;
+    }
+    void swap(trie_pool &other) {
+        chunks.swap(other.chunks);
+        std::swap(slot_size, other.slot_size);
+        std::swap(shift, other.shift);
+        std::swap(used, other.used);
+        std::swap(free_head, other.free_head);
+    }
+
+    std::size_t bytes() const { return chunks.size() * chunk_bytes(); }
+};
+
+// The pools of one trie, with leaves holding a V each
+template < typename V >
+class trie_nodes {
+    trie_pool leaves, node4s, node16s, node48s, node256s;
+
+    // non-copyable; see assign
+    trie_nodes(trie_nodes const &);
+    trie_nodes &operator=(trie_nodes const &);
+
+    trie_pool &pool(trie_kind k) {
+        switch ( k ) {
+          case trie_leaf_kind: return leaves;
+          case trie_node4_kind: return node4s;
+          case trie_node16_kind: return node16s;
+          case trie_node48_kind: return node48s;
+          default: return node256s;
+        }
+    }
+
+#ifdef ASSIST_HAS_CXX11
+    static bool const trivial_leaves = std::is_trivially_destructible<V>::value;
+#else
+    static bool const trivial_leaves = false;
+#endif
+
+    // Copies the first done leaves under n, in order, from other's slots
+    // into the same ones here; done counts them
+    void copy_leaves(trie_nodes const &other, trie_ref n, std::size_t &done) {
+        if ( !n ) return;
+        if ( is_trie_leaf(n) ) {
+            ::new(leaves[ref_slot(n)]) V(*other.leaf(n));
+            ++done;
+            return;
+        }
+        trie_inner const *const p = other.inner(n);
+        copy_leaves(other, p->value, done);
+        for ( int pos = next_child(p, 0); pos >= 0;
+              pos = next_child(p, pos+1) ) {
+            copy_leaves(other, child_at(p, pos), done);
+        }
+    }
+    // Destroys up to left of the leaves under n, in order
+    void destroy_leaves(trie_ref n, std::size_t &left) {
+        if ( !n || !left ) return;
+        if ( is_trie_leaf(n) ) {
+            leaf(n)->~V();
+            --left;
+            return;
+        }
+        trie_inner const *const p = inner(n);
+        destroy_leaves(p->value, left);
+        for ( int pos = next_child(p, 0); pos >= 0 && left;
+              pos = next_child(p, pos+1) ) {
+            destroy_leaves(child_at(p, pos), left);
+        }
+    }
+
+  public:
+    // Construct/Copy/Destroy
+    trie_nodes()
+     : leaves(sizeof(V)),
+       node4s(sizeof(trie_node4)), node16s(sizeof(trie_node16)),
+       node48s(sizeof(trie_node48)), node256s(sizeof(trie_node256)) {}
+    // destroy the leaves first; the pools only free their chunks
+
+    trie_inner *inner(trie_ref r) const {
+        std::size_t const i = ref_slot(r);
+        switch ( ref_kind(r) ) {
+          case trie_node4_kind: return static_cast<trie_node4 *>(node4s[i]);
+          case trie_node16_kind: return static_cast<trie_node16 *>(node16s[i]);
+          case trie_node48_kind: return static_cast<trie_node48 *>(node48s[i]);
+          default: return static_cast<trie_node256 *>(node256s[i]);
+        }
+    }
+    V *leaf(trie_ref r) const {
+        return static_cast<V *>(leaves[ref_slot(r)]);
+    }
+
+    trie_ref new_leaf(V const &v) {
+        std::size_t const i = leaves.allocate();
+        try {
+            ::new(leaves[i]) V(v);
+        } catch (...) {
+            leaves.deallocate(i);
+            throw;
+        }
+        return make_trie_ref(trie_leaf_kind, i);
+    }
+    void delete_leaf(trie_ref r) {
+        leaf(r)->~V();
+        leaves.deallocate(ref_slot(r));
+    }
+    trie_ref new_inner(trie_kind k) {
+        std::size_t const i = pool(k).allocate();
+        switch ( k ) {
+          case trie_node4_kind: ::new(node4s[i]) trie_node4; break;
+          case trie_node16_kind: ::new(node16s[i]) trie_node16; break;
+          case trie_node48_kind: ::new(node48s[i]) trie_node48; break;
+          default: ::new(node256s[i]) trie_node256;
+        }
+        return make_trie_ref(k, i);
+    }
+    // Inner nodes are trivially destructible
+    void delete_inner(trie_ref r) {
+        pool(ref_kind(r)).deallocate(ref_slot(r));
+    }
+
+    // n's contents moved into a new node of kind k, which must have
+    // room; n is deleted
+    trie_ref resize(trie_ref n, trie_kind k) {
+        trie_ref const r = new_inner(k);
+        trie_inner *const to = inner(r);
+        trie_inner const *const from = inner(n);
+        to->prefix_len = from->prefix_len;
+        std::memcpy(to->prefix, from->prefix, trie_prefix_bytes);
+        to->value = from->value;
+        for ( int pos = next_child(from, 0); pos >= 0;
+              pos = next_child(from, pos+1) ) {
+            add_child(to, byte_at(from, pos), child_at(from, pos));
+        }
+        delete_inner(n);
+        return r;
+    }
+    trie_ref grow(trie_ref n) {
+        return resize(n, trie_kind(ref_kind(n) + 1));
+    }
+    // A smaller node, if n has few enough children to be worth moving
+    trie_ref shrink(trie_ref n) {
+        unsigned const count = inner(n)->count;
+        switch ( ref_kind(n) ) {
+          case trie_node16_kind:
+            return count <= 3 ? resize(n, trie_node4_kind) : n;
+          case trie_node48_kind:
+            return count <= 12 ? resize(n, trie_node16_kind) : n;
+          case trie_node256_kind:
+            return count <= 40 ? resize(n, trie_node48_kind) : n;
+          default:
+            return n;
+        }
+    }
+
+    // The first leaf in order below n
+    trie_ref min_leaf(trie_ref n) const {
+        while ( !is_trie_leaf(n) ) n = min_leaf_step(inner(n));
+        return n;
+    }
+    trie_ref min_leaf(trie_inner const *p) const {
+        return min_leaf(min_leaf_step(p));
+    }
+    static trie_ref min_leaf_step(trie_inner const *p) {
+        return p->value ? p->value : child_at(p, next_child(p, 0));
+    }
+    // How many leaves are under n
+    std::size_t count_leaves(trie_ref n) const {
+        if ( is_trie_leaf(n) ) return 1;
+        trie_inner const *const p = inner(n);
+        std::size_t total = p->value ? 1 : 0;
+        for ( int pos = next_child(p, 0); pos >= 0;
+              pos = next_child(p, pos+1) ) {
+            total += count_leaves(child_at(p, pos));
+        }
+        return total;
+    }
+
+    // Destroys the items leaves under root, and frees every node
+    void clear(trie_ref root, std::size_t items) {
+        if ( !trivial_leaves ) destroy_leaves(root, items);
+        leaves.release();
+        node4s.release();
+        node16s.release();
+        node48s.release();
+        node256s.release();
+    }
+    // other's nodes, in the same slots, with those under root the only
+    // leaves in use; must be empty to start with
+    void assign(trie_nodes const &other, trie_ref root) {
+        leaves.assign(other.leaves);
+        node4s.assign(other.node4s);
+        node16s.assign(other.node16s);
+        node48s.assign(other.node48s);
+        node256s.assign(other.node256s);
+        std::size_t done = 0;
+        try {
+            copy_leaves(other, root, done);
+        } catch (...) {
+            clear(root, done);
+            throw;
+        }
+    }
+
+    // Bytes taken by the chunks, used or not
+    std::size_t bytes() const {
+        return leaves.bytes() + node4s.bytes() + node16s.bytes()
+             + node48s.bytes() + node256s.bytes();
+    }
+};
+
+// One step of the way down to an iterator's leaf
+struct trie_frame {
+    trie_inner const *node;
+    // a child's position, or one of these
+    int pos;
+    enum { before = -2, at_value = -1 };
+};
+// Deep enough for the branches along most keys without allocating
+typedef small_vector<trie_frame, 16> trie_path;
+
+// Walks the leaves in order, with the path from the root to the
+// current one on its own stack, so nodes need no parent pointers
+template < typename V, typename Reference, typename Pointer >
+class trie_iterator {
+    trie_nodes<V> const *nodes;
+    trie_path path;
+    V const *at;
+
+    template < typename, typename, typename >
+    friend class trie_iterator;
+
+    // Moves to the next leaf from the top frame's position on
+    void advance() {
+        while ( !path.empty() ) {
+            trie_frame &f = path.back();
+            trie_ref next = 0;
+            if ( f.pos == trie_frame::before ) {
+                f.pos = trie_frame::at_value;
+                next = f.node->value;
+            }
+            if ( !next ) {
+                int const pos = next_child(f.node, f.pos+1);
+                if ( pos < 0 ) {
+                    path.pop_back();
+                    continue;
+                }
+                f.pos = pos;
+                next = child_at(f.node, pos);
+            }
+            if ( is_trie_leaf(next) ) {
+                at = nodes->leaf(next);
+                return;
+            }
+            trie_frame const down = { nodes->inner(next), trie_frame::before };
+            path.push_back(down);
+        }
+        at = 0;
+    }
+
+  public:
+    // Types
+    typedef std::forward_iterator_tag iterator_category;
+    typedef V value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Reference reference;
+    typedef Pointer pointer;
+
+    // Construct/Copy/Destroy
+    trie_iterator() : nodes(0), at(0) {}
+    // The first leaf under root
+    trie_iterator(trie_nodes<V> const *t, trie_ref root)
+     : nodes(t), at(0) {
+        if ( !root ) return;
+        if ( is_trie_leaf(root) ) {
+            at = nodes->leaf(root);
+            return;
+        }
+        trie_frame const top = { nodes->inner(root), trie_frame::before };
+        path.push_back(top);
+        advance();
+    }
+    // The first leaf under n, which is reached by way of p
+    trie_iterator(trie_nodes<V> const *t, trie_path const &p, trie_ref n)
+     : nodes(t), path(p), at(0) {
+        if ( is_trie_leaf(n) ) {
+            at = nodes->leaf(n);
+            return;
+        }
+        trie_frame const down = { nodes->inner(n), trie_frame::before };
+        path.push_back(down);
+        advance();
+    }
+    // The first leaf past everything under the child the top of p is at
+    trie_iterator(trie_nodes<V> const *t, trie_path const &p)
+     : nodes(t), path(p), at(0) {
+        advance();
+    }
+    // iterator to const_iterator
+    template < typename R, typename P >
+    trie_iterator(trie_iterator<V, R, P> const &other)
+     : nodes(other.nodes), path(other.path), at(other.at) {}
+    // default copy ctr
+    // default destructor
+    // default assignment
+
+    reference operator*() const { return *const_cast<V *>(at); }
+    pointer operator->() const { return &**this; }
+
+    trie_iterator &operator++() {
+        advance();
+        return *this;
+    }
+    trie_iterator operator++(int) {
+        trie_iterator old(*this);
+        advance();
+        return old;
+    }
+
+    // Comparison Operators
+    template < typename R, typename P >
+    bool operator==(trie_iterator<V, R, P> const &other) const {
+        return at == other.at;
+    }
+    template < typename R, typename P >
+    bool operator!=(trie_iterator<V, R, P> const &other) const {
+        return at != other.at;
+    }
+};
+
+} // namespace detail
+} // namespace assist
+
+#endif
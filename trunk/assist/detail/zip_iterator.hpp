@@ -0,0 +1,234 @@
+#ifndef ASSIST_DETAIL_ZIP_ITERATOR_HPP
+#define ASSIST_DETAIL_ZIP_ITERATOR_HPP
+
+/*
+ * assist/detail/zip_iterator.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* Walks a key container and a mapped container in step, for the split
+ * map adapters.  Dereferencing gives a ref_pair, a pair of references
+ * that converts to the value_type, so it->first and it->second work as
+ * they do for the other adapters, but there's no value_type object to
+ * take the address of.
+ */
+
+#include <iterator> // iterator_traits, random_access_iterator_tag
+#include <utility> // pair
+#include <vector>
+#include <algorithm> // stable_sort, adjacent_find
+#include <cstddef> // size_t
+
+#include "compare.hpp"
+
+namespace assist {
+namespace detail {
+
+// std::pair can't hold references before C++11
+template < typename First, typename Second >
+struct ref_pair {
+    First first;
+    Second second;
+    ref_pair(First f, Second s) : first(f), second(s) {}
+    template < typename T1, typename T2 >
+    operator std::pair<T1, T2>() const {
+        return std::pair<T1, T2>(first, second);
+    }
+};
+template < typename F1, typename S1, typename F2, typename S2 >
+bool operator==(ref_pair<F1, S1> const &lhs, ref_pair<F2, S2> const &rhs) {
+    return lhs.first == rhs.first && lhs.second == rhs.second;
+}
+template < typename F1, typename S1, typename F2, typename S2 >
+bool operator<(ref_pair<F1, S1> const &lhs, ref_pair<F2, S2> const &rhs) {
+    return lhs.first < rhs.first ||
+           ( !(rhs.first < lhs.first) && lhs.second < rhs.second );
+}
+
+// What operator-> returns when operator* returns by value
+template < typename Reference >
+struct arrow_proxy {
+    Reference r;
+    arrow_proxy(Reference ref) : r(ref) {}
+    Reference *operator->() { return &r; }
+};
+
+template < typename KeyIterator, typename MappedIterator >
+class zip_iterator {
+    typedef std::iterator_traits<KeyIterator> key_traits;
+    typedef std::iterator_traits<MappedIterator> mapped_traits;
+    KeyIterator k;
+    MappedIterator m;
+
+  public:
+    // Types
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef std::pair<typename key_traits::value_type,
+                      typename mapped_traits::value_type> value_type;
+    typedef ref_pair<typename key_traits::reference,
+                     typename mapped_traits::reference> reference;
+    typedef arrow_proxy<reference> pointer;
+    typedef typename key_traits::difference_type difference_type;
+
+    // Construct/Copy/Destroy
+    zip_iterator() : k(), m() {}
+    zip_iterator(KeyIterator ki, MappedIterator mi) : k(ki), m(mi) {}
+    // iterator to const_iterator
+    template < typename K, typename M >
+    zip_iterator(zip_iterator<K, M> const &other)
+     : k(other.key_iterator()), m(other.mapped_iterator()) {}
+
+    KeyIterator key_iterator() const { return k; }
+    MappedIterator mapped_iterator() const { return m; }
+
+    reference operator*() const { return reference(*k, *m); }
+    pointer operator->() const { return pointer(**this); }
+    reference operator[](difference_type n) const {
+        return reference(k[n], m[n]);
+    }
+
+    zip_iterator &operator++() { ++k; ++m; return *this; }
+    zip_iterator &operator--() { --k; --m; return *this; }
+    zip_iterator operator++(int) { zip_iterator t(*this); ++*this; return t; }
+    zip_iterator operator--(int) { zip_iterator t(*this); --*this; return t; }
+    zip_iterator &operator+=(difference_type n) { k += n; m += n; return *this; }
+    zip_iterator &operator-=(difference_type n) { k -= n; m -= n; return *this; }
+    zip_iterator operator+(difference_type n) const { return zip_iterator(k+n, m+n); }
+    zip_iterator operator-(difference_type n) const { return zip_iterator(k-n, m-n); }
+    friend zip_iterator operator+(difference_type n, zip_iterator const &it) {
+        return it + n;
+    }
+
+    // The keys always move together with the mapped values, so the
+    // key iterators alone settle all of these.
+    template < typename M >
+    difference_type operator-(zip_iterator<KeyIterator, M> const &other) const {
+        return k - other.key_iterator();
+    }
+    template < typename M >
+    bool operator==(zip_iterator<KeyIterator, M> const &other) const {
+        return k == other.key_iterator();
+    }
+    template < typename M >
+    bool operator!=(zip_iterator<KeyIterator, M> const &other) const {
+        return k != other.key_iterator();
+    }
+    template < typename M >
+    bool operator<(zip_iterator<KeyIterator, M> const &other) const {
+        return k < other.key_iterator();
+    }
+    template < typename M >
+    bool operator<=(zip_iterator<KeyIterator, M> const &other) const {
+        return k <= other.key_iterator();
+    }
+    template < typename M >
+    bool operator>(zip_iterator<KeyIterator, M> const &other) const {
+        return k > other.key_iterator();
+    }
+    template < typename M >
+    bool operator>=(zip_iterator<KeyIterator, M> const &other) const {
+        return k >= other.key_iterator();
+    }
+};
+
+// Orders positions in a key container by the keys there
+template < typename key_container, typename CMP >
+struct index_compare {
+    key_container const *keys;
+    CMP comparator;
+    index_compare(key_container const &kc, CMP cmp)
+     : keys(&kc), comparator(cmp) {}
+    bool operator()(std::size_t lhs, std::size_t rhs) const {
+        return comparator((*keys)[lhs], (*keys)[rhs]);
+    }
+};
+
+// Sorts keys, and values alongside them, by key, from position from on;
+// equivalent keys keep their order, and if unique only the first of
+// them is kept.  The elements before from are left alone.
+template < typename key_container, typename mapped_container, typename CMP >
+void sort_split(key_container &keys, mapped_container &values,
+                CMP cmp, bool unique, std::size_t from = 0) {
+    bool const ordered = unique
+        ? std::adjacent_find(keys.begin()+from, keys.end(),
+              negated_compare<CMP>(cmp)) == keys.end()
+        : std::adjacent_find(keys.begin()+from, keys.end(),
+              reversed_compare<CMP>(cmp)) == keys.end();
+    if ( ordered ) return;
+
+    std::vector<std::size_t> order(keys.size() - from);
+    for ( std::size_t i = 0; i != order.size(); ++i ) order[i] = from+i;
+    std::stable_sort(order.begin(), order.end(),
+                     index_compare<key_container, CMP>(keys, cmp));
+
+    key_container sorted_keys;
+    mapped_container sorted_values;
+    sorted_keys.reserve(order.size());
+    sorted_values.reserve(order.size());
+    for ( std::size_t i = 0; i != order.size(); ++i ) {
+        if ( unique && i != 0 &&
+             !cmp(keys[order[i-1]], keys[order[i]]) ) {
+            continue;
+        }
+        sorted_keys.push_back(keys[order[i]]);
+        sorted_values.push_back(values[order[i]]);
+    }
+    if ( from == 0 ) {
+        keys.swap(sorted_keys);
+        values.swap(sorted_values);
+        return;
+    }
+    keys.erase(keys.begin()+from, keys.end());
+    values.erase(values.begin()+from, values.end());
+    keys.insert(keys.end(), sorted_keys.begin(), sorted_keys.end());
+    values.insert(values.end(), sorted_values.begin(), sorted_values.end());
+}
+
+// Merges the sorted runs [0,mid) and [mid,end) of keys, and values
+// alongside them, in one pass.  Equivalent keys keep their order; if
+// unique, a key from the second run equivalent to one in the first is
+// dropped.  A second run that belongs wholly after the first, as
+// appends do, costs only the check.
+template < typename key_container, typename mapped_container, typename CMP >
+void merge_split(key_container &keys, mapped_container &values,
+                 std::size_t mid, CMP cmp, bool unique) {
+    std::size_t const n = keys.size();
+    if ( mid == 0 || mid == n ) return;
+    if ( unique ? cmp(keys[mid-1], keys[mid])
+                : !cmp(keys[mid], keys[mid-1]) ) return;
+
+    key_container merged_keys;
+    mapped_container merged_values;
+    merged_keys.reserve(n);
+    merged_values.reserve(n);
+    std::size_t i = 0, j = mid;
+    while ( i != mid && j != n ) {
+        if ( cmp(keys[j], keys[i]) ) {
+            merged_keys.push_back(keys[j]);
+            merged_values.push_back(values[j]);
+            ++j;
+        } else {
+            if ( unique && !cmp(keys[i], keys[j]) ) ++j;
+            merged_keys.push_back(keys[i]);
+            merged_values.push_back(values[i]);
+            ++i;
+        }
+    }
+    merged_keys.insert(merged_keys.end(), keys.begin()+i, keys.begin()+mid);
+    merged_values.insert(merged_values.end(),
+                         values.begin()+i, values.begin()+mid);
+    merged_keys.insert(merged_keys.end(), keys.begin()+j, keys.end());
+    merged_values.insert(merged_values.end(), values.begin()+j, values.end());
+    keys.swap(merged_keys);
+    values.swap(merged_values);
+}
+
+} // namespace detail
+} // namespace assist
+
+#endif
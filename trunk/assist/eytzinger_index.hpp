@@ -0,0 +1,272 @@
+#ifndef ASSIST_EYTZINGER_INDEX_HPP
+#define ASSIST_EYTZINGER_INDEX_HPP
+
+/*
+ * assist/eytzinger_index.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* A frozen lookup layout for any of the sorted adapters.
+ * The adapter's sorted elements are read as blocks of node_size, and
+ * above them sit layers of nodes holding the first key of each block
+ * or subtree: a static B+ tree, its nodes numbered breadth-first as in
+ * an Eytzinger layout, so that the children of node i are nodes
+ * i*(node_size+1) and on of the next layer down.  A lookup reads one
+ * node per layer, a cache line or a few, and then one block of the
+ * adapter, where the plain binary search touches a line per halving.
+ * Only the separators are copied, about a node_size'th of the keys;
+ * the adapter is untouched, so ordered iteration still works, and
+ * results come back as the adapter's own const_iterators, their
+ * position following from the block the search ends in.
+ *
+ * WARNING: Any modification of the adapter invalidates the index;
+ * call rebuild() afterwards, as you would re-fetch an iterator.
+ */
+
+#include <vector>
+#include <utility> // pair
+#include <cstddef> // size_t
+
+#include "detail/config.hpp"
+#include "detail/key_extractor.hpp"
+#include "detail/sorted_search.hpp"
+
+namespace assist {
+
+namespace detail {
+
+// Counts the keys of the sorted p[0,n) less than (or, if or_equal, not
+// greater than) k.  For a full node of 32-bit integers ordered by
+// std::less, the comparisons are packed into one mask, and as the keys
+// are sorted the count is where its run of ones ends.
+template < typename T, typename CMP,
+           bool Simd = simd_key_traits<T>::enabled,
+           std::size_t Size = sizeof(T) >
+struct node_count {
+    static std::size_t count(T const *p, std::size_t n, T const &k,
+                             CMP const &cmp, bool or_equal) {
+        std::size_t c = 0;
+        for ( std::size_t j = 0; j != n; ++j ) {
+            c += or_equal ? !cmp(k, p[j]) : cmp(p[j], k);
+        }
+        return c;
+    }
+};
+
+#if defined(__SSE2__) || defined(_M_X64)
+template < typename T >
+struct node_count<T, std::less<T>, true, 4> {
+    static std::size_t count(T const *p, std::size_t n, T const &k,
+                             std::less<T> const &cmp, bool or_equal) {
+        if ( n != 16 ) {
+            return node_count<T, std::less<T>, false>::count(p, n, k, cmp,
+                                                             or_equal);
+        }
+        int const flip = simd_key_traits<T>::is_signed ? 0 : int(0x80000000u);
+        __m128i const kv = _mm_set1_epi32(int(k) ^ flip);
+        __m128i const fv = _mm_set1_epi32(flip);
+        __m128i m[4];
+        for ( int i = 0; i != 4; ++i ) {
+            __m128i const v = _mm_xor_si128(fv, _mm_loadu_si128(
+                                  reinterpret_cast<__m128i const *>(p+4*i)));
+            m[i] = or_equal ? _mm_cmpgt_epi32(v, kv) : _mm_cmpgt_epi32(kv, v);
+        }
+        unsigned const mask = unsigned(_mm_movemask_epi8(_mm_packs_epi16(
+                                  _mm_packs_epi32(m[0], m[1]),
+                                  _mm_packs_epi32(m[2], m[3]))));
+        // the greater keys end the node, the lesser ones start it
+        return or_equal ? count_trailing_zeros(mask | 0x10000u)
+                        : count_trailing_zeros(~mask);
+    }
+};
+#endif
+
+} // namespace detail
+
+template < typename adapter_type >
+class eytzinger_index {
+  public:
+    // Types
+    typedef adapter_type adapter;
+    typedef typename adapter_type::key_type key_type;
+    typedef typename adapter_type::value_type value_type;
+    typedef typename adapter_type::key_compare key_compare;
+    typedef typename adapter_type::size_type size_type;
+    typedef typename adapter_type::difference_type difference_type;
+    typedef typename adapter_type::const_iterator const_iterator;
+
+  private:
+    // Keys per node: a cache line of 32-bit keys; for wider ones more
+    // than a line, but a shallower tree, measured the better trade
+    static size_type const node_size = sizeof(key_type) > 4 ? 8 : 16;
+    static size_type const fanout = node_size + 1;
+
+    adapter_type const *a;
+    // The separator nodes, node_size keys each, the root's layer first.
+    // Key j of a node is the first key under its child j+1.
+    std::vector<key_type> keys;
+    // For layer h above the blocks of the adapter (h = 0), how many
+    // nodes it has and where in keys, counted in nodes, it starts
+    std::vector<size_type> widths, starts;
+    // where in keys node 0 is, so that the nodes line up with cache lines
+    size_type first;
+    // The adapter's last key, which also pads out the last node of a layer
+    key_type greatest;
+    key_compare comparator;
+
+    // How many of the n keys of a node, or of a block of the adapter
+    // starting at b, are less than (or, if Upper, not greater than) k
+    template < bool Upper >
+    size_type count_node(key_type const *p, size_type n,
+                         key_type const &k) const {
+        return detail::node_count<key_type, key_compare>::count(
+                   p, n, k, comparator, Upper);
+    }
+    template < bool Upper, typename base_type >
+    size_type count_block(base_type const &, size_type b, size_type n,
+                          key_type const &k) const {
+        const_iterator const p = a->begin() + b;
+        detail::key_extractor<key_type, value_type> key_of;
+        size_type c = 0;
+        for ( size_type j = 0; j != n; ++j ) {
+            c += Upper ? !comparator(k, key_of(p[j]))
+                       : comparator(key_of(p[j]), k);
+        }
+        return c;
+    }
+    template < bool Upper, typename A >
+    size_type count_block(std::vector<key_type, A> const &v, size_type b,
+                          size_type n, key_type const &k) const {
+        return count_node<Upper>(&v[b], n, k);
+    }
+
+    // The rank in the adapter of the first key not less than
+    // (or, if Upper, greater than) k
+    template < bool Upper >
+    size_type rank(key_type const &k) const {
+        size_type const n = a->size();
+        // past the greatest key the padding would count too, and lead
+        // to children that aren't there
+        if ( !n || ( Upper ? !comparator(k, greatest)
+                           : comparator(greatest, k) ) ) {
+            return n;
+        }
+        size_type i = 0;
+        for ( size_type h = starts.size()-1; h != 0; --h ) {
+            key_type const *const p = &keys[first + (starts[h]+i)*node_size];
+            i = i*fanout + count_node<Upper>(p, node_size, k);
+        }
+        size_type const b = i*node_size;
+        size_type const m = n - b;
+        return b + ( m < node_size
+                     ? count_block<Upper>(a->base(), b, m, k)
+                     : count_block<Upper>(a->base(), b, node_size, k) );
+    }
+
+  public:
+    // Construct/Copy/Destroy
+    explicit eytzinger_index(adapter_type const &c)
+     : a(&c), first(0), comparator(c.key_comp()) { rebuild(); }
+    // default copy ctr
+    // default destructor
+    // default assignment
+
+    // Re-freezes the layout from the adapter's current contents.
+    void rebuild() {
+        size_type const n = a->size();
+        widths.assign(1, ( n + node_size-1 ) / node_size);
+        while ( widths.back() > 1 ) {
+            widths.push_back(( widths.back() + node_size ) / fanout);
+        }
+        starts.assign(widths.size(), 0);
+        size_type nodes = 0;
+        for ( size_type h = widths.size()-1; h != 0; --h ) {
+            starts[h] = nodes;
+            nodes += widths[h];
+        }
+        size_type const line = 64 / sizeof(key_type) * sizeof(key_type) == 64
+                             ? 64 / sizeof(key_type) : 0;
+        std::vector<key_type>(nodes*node_size + line).swap(keys);
+        std::size_t const at = reinterpret_cast<std::size_t>(&keys[0]);
+        first = line && at % sizeof(key_type) == 0
+              ? ( 64 - at % 64 ) % 64 / sizeof(key_type) : 0;
+
+        typename adapter_type::const_iterator const b = a->begin();
+        detail::key_extractor<key_type, value_type> key_of;
+        greatest = n ? key_of(b[n-1]) : key_type();
+        // blocks under each node of the layer being filled
+        size_type span = 1;
+        for ( size_type h = 1; h != widths.size(); ++h, span *= fanout ) {
+            key_type *p = &keys[first + starts[h]*node_size];
+            for ( size_type i = 0; i != widths[h]; ++i ) {
+                for ( size_type j = 1; j != fanout; ++j ) {
+                    size_type const child = i*fanout + j;
+                    *p++ = child < widths[h-1]
+                         ? key_of(b[child*span*node_size]) : greatest;
+                }
+            }
+        }
+    }
+
+    adapter_type const &base() const { return *a; }
+
+    // Capacity
+    bool empty() const { return a->empty(); }
+    size_type size() const { return a->size(); }
+
+    // Observers
+    key_compare key_comp() const { return comparator; }
+
+    // Set operations
+    size_type count(const key_type &k) const {
+        return rank<true>(k) - rank<false>(k);
+    }
+    std::pair<const_iterator, const_iterator> equal_range(const key_type &k) const {
+        return std::make_pair(lower_bound(k), upper_bound(k));
+    }
+    const_iterator find(const key_type &k) const {
+        const_iterator const it = lower_bound(k);
+        detail::key_extractor<key_type, value_type> key_of;
+        return it == a->end() || comparator(k, key_of(*it)) ? a->end() : it;
+    }
+    const_iterator lower_bound(const key_type &k) const {
+        return a->begin() + rank<false>(k);
+    }
+    const_iterator upper_bound(const key_type &k) const {
+        return a->begin() + rank<true>(k);
+    }
+    bool contains(const key_type &k) const {
+        return find(k) != a->end();
+    }
+
+    void swap(eytzinger_index &other) {
+        std::swap( a, other.a );
+        std::swap( first, other.first );
+        std::swap( greatest, other.greatest );
+        std::swap( comparator, other.comparator );
+        keys.swap(other.keys);
+        widths.swap(other.widths);
+        starts.swap(other.starts);
+    }
+};
+
+template < typename adapter_type >
+eytzinger_index<adapter_type> make_eytzinger_index(adapter_type const &c) {
+    return eytzinger_index<adapter_type>(c);
+}
+
+// Overloaded Algorithms
+template < typename adapter_type >
+void swap(eytzinger_index<adapter_type> &lhs,
+          eytzinger_index<adapter_type> &rhs) {
+    lhs.swap(rhs);
+}
+
+} // namespace assist
+
+#endif
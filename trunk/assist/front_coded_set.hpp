@@ -0,0 +1,363 @@
+#ifndef ASSIST_FRONT_CODED_SET_HPP
+#define ASSIST_FRONT_CODED_SET_HPP
+
+/*
+ * assist/front_coded_set.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* A frozen set of strings, front coded: the strings are cut into
+ * blocks, and within a block each string after the first is stored as
+ * the length it shares with the one before plus the rest of it.  For
+ * keys with long common prefixes (URLs, paths) that's several times
+ * smaller than a std::vector<std::string>, with no allocation per key.
+ *
+ * Everything lives in one byte array.  A search binary searches the
+ * first string of each block, stored whole, then decodes one block,
+ * so it only ever touches the block offsets and that byte array.
+ *
+ * Ordered as std::less<std::string>.  Searches compare against the
+ * encoded bytes and allocate nothing; iterators decode as they go, from
+ * the first time they're dereferenced, so they're forward only, and *it
+ * refers into the iterator itself.
+ */
+
+#include <string>
+#include <vector>
+#include <iterator> // forward_iterator_tag
+#include <algorithm> // sort, unique, adjacent_find
+#include <functional> // less
+#include <utility> // pair
+#include <cstddef> // size_t, ptrdiff_t
+#include <cassert>
+
+#include "detail/config.hpp"
+#include "set_adapter.hpp"
+#include "tags.hpp"
+
+namespace assist {
+
+namespace detail {
+
+// Lengths are stored 7 bits a byte, low bits first
+inline void put_varint(std::vector<char> &out, std::size_t v) {
+    for ( ; v >= 0x80; v >>= 7 ) out.push_back(char(v | 0x80));
+    out.push_back(char(v));
+}
+inline std::size_t get_varint(char const *&p) {
+    std::size_t v = 0;
+    for ( unsigned shift = 0; ; shift += 7 ) {
+        unsigned char const b = static_cast<unsigned char>(*p++);
+        v |= std::size_t(b & 0x7f) << shift;
+        if ( !(b & 0x80) ) return v;
+    }
+}
+
+} // namespace detail
+
+class front_coded_set {
+  public:
+    // Types
+    typedef std::string key_type;
+    typedef key_type value_type;
+    typedef std::less<key_type> key_compare;
+    typedef key_compare value_compare;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    class const_iterator {
+        front_coded_set const *s;
+        size_type i;
+        // Decoded on first use, so a search that only compares never
+        // builds a string.  next is where the string after current is
+        // encoded, or 0 while nothing is decoded.
+        mutable char const *next;
+        mutable std::string current;
+        friend class front_coded_set;
+
+        const_iterator(front_coded_set const *fcs, size_type index)
+         : s(fcs), i(index), next(0) {}
+        // Reads string j, which starts a block or follows current
+        void decode(size_type j) const {
+            if ( j % s->block == 0 ) {
+                next = &s->bytes[0] + s->offsets[j / s->block];
+                std::size_t const length = detail::get_varint(next);
+                current.assign(next, length);
+                next += length;
+            } else {
+                std::size_t const shared = detail::get_varint(next);
+                std::size_t const length = detail::get_varint(next);
+                current.erase(shared);
+                current.append(next, length);
+                next += length;
+            }
+        }
+        // Reads string i from the start of its block
+        void seek() const {
+            size_type j = i - i % s->block;
+            decode(j);
+            while ( j != i ) decode(++j);
+        }
+
+      public:
+        // Types
+        typedef std::forward_iterator_tag iterator_category;
+        typedef std::string value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef std::string const *pointer;
+        typedef std::string const &reference;
+
+        const_iterator() : s(0), i(0), next(0) {}
+
+        reference operator*() const {
+            if ( !next ) seek();
+            return current;
+        }
+        pointer operator->() const { return &**this; }
+        const_iterator &operator++() {
+            // once decoding, keep up, as the next string builds on this one
+            if ( ++i != s->n && next ) decode(i);
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator t(*this);
+            ++*this;
+            return t;
+        }
+        // Position in the set
+        size_type index() const { return i; }
+
+        bool operator==(const_iterator const &other) const { return i == other.i; }
+        bool operator!=(const_iterator const &other) const { return i != other.i; }
+    };
+    typedef const_iterator iterator;
+
+  private:
+    std::vector<char> bytes;
+    // where each block starts in bytes
+    std::vector<size_type> offsets;
+    size_type n;
+    size_type block;
+
+    // Compares p[0,length) with k from position from on, as
+    // std::string::compare would compare them
+    static int compare(char const *p, std::size_t length, key_type const &k,
+                       std::size_t from = 0) {
+        std::size_t const rest = k.size() - from;
+        std::size_t const common = length < rest ? length : rest;
+        int const r = std::char_traits<char>::compare(p, k.data()+from, common);
+        if ( r != 0 ) return r;
+        return length < rest ? -1 : length > rest ? 1 : 0;
+    }
+    // from plus how many of p[0,length) match k from position from on
+    static std::size_t common_prefix(char const *p, std::size_t length,
+                                     key_type const &k, std::size_t from) {
+        std::size_t const most = from + ( length < k.size() - from
+                                          ? length : k.size() - from );
+        std::size_t m = from;
+        while ( m != most && *p == k[m] ) ++p, ++m;
+        return m;
+    }
+    // The first string of block b
+    int compare_first(size_type b, key_type const &k) const {
+        char const *p = &bytes[0] + offsets[b];
+        std::size_t const length = detail::get_varint(p);
+        return compare(p, length, k);
+    }
+    // First position whose string is not less than (or, if upper,
+    // greater than) k; equal says whether that string is k.  The block
+    // is compared in place: match is how much of k the string before
+    // shares, so a string sharing more with that one than match orders
+    // as it does, one sharing less is greater than k, and only one
+    // sharing exactly match needs its suffix compared.
+    size_type locate(key_type const &k, bool upper, bool &equal) const {
+        equal = false;
+        // blocks [0,lo) start at or below k
+        size_type lo = 0, len = offsets.size();
+        while ( len > 0 ) {
+            size_type const half = len/2;
+            int const c = compare_first(lo+half, k);
+            if ( c < 0 || ( upper && c == 0 ) ) {
+                lo += half+1;
+                len -= half+1;
+            } else {
+                len = half;
+            }
+        }
+        size_type const last = lo*block < n ? lo*block : n;
+        if ( lo != 0 ) {
+            char const *p = &bytes[0] + offsets[lo-1];
+            std::size_t length = detail::get_varint(p);
+            std::size_t match = common_prefix(p, length, k, 0);
+            p += length;
+            for ( size_type j = (lo-1)*block+1; j != last; ++j ) {
+                std::size_t const shared = detail::get_varint(p);
+                length = detail::get_varint(p);
+                int c;
+                if ( shared > match ) {
+                    c = -1;
+                } else if ( shared < match ) {
+                    c = 1;
+                } else {
+                    std::size_t const m = common_prefix(p, length, k, shared);
+                    c = compare(p + (m - shared), shared + length - m, k, m);
+                    match = m;
+                }
+                p += length;
+                if ( c > 0 || ( !upper && c == 0 ) ) {
+                    equal = c == 0;
+                    return j;
+                }
+            }
+        }
+        // past the block: the answer is the first string of block lo
+        equal = !upper && lo != offsets.size() && compare_first(lo, k) == 0;
+        return last;
+    }
+
+    template <class InputIterator>
+    void build(InputIterator b, InputIterator e) {
+        std::string previous;
+        for ( ; b != e; ++b, ++n ) {
+            std::string const &k = *b;
+            if ( n % block == 0 ) {
+                offsets.push_back(bytes.size());
+                detail::put_varint(bytes, k.size());
+                bytes.insert(bytes.end(), k.begin(), k.end());
+            } else {
+                std::size_t shared = 0;
+                std::size_t const most = k.size() < previous.size()
+                                         ? k.size() : previous.size();
+                while ( shared != most && k[shared] == previous[shared] ) {
+                    ++shared;
+                }
+                detail::put_varint(bytes, shared);
+                detail::put_varint(bytes, k.size()-shared);
+                bytes.insert(bytes.end(), k.begin()+shared, k.end());
+            }
+            previous = k;
+        }
+        // so &bytes[0] is always valid
+        if ( bytes.empty() ) bytes.push_back(0);
+        std::vector<char>(bytes).swap(bytes);
+        std::vector<size_type>(offsets).swap(offsets);
+    }
+
+  public:
+    // Construct/Copy/Destroy
+    explicit front_coded_set(size_type block_size = 16)
+     : bytes(1), n(0), block(block_size ? block_size : 1) {}
+    // Sorts and removes duplicates first
+    template <class InputIterator>
+    front_coded_set(InputIterator b, InputIterator e,
+                    size_type block_size = 16)
+     : n(0), block(block_size ? block_size : 1) {
+        std::vector<std::string> keys(b, e);
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        build(keys.begin(), keys.end());
+    }
+    // [b,e) must already be strictly increasing, like a set_adapter's
+    // contents: front_coded_set(sorted_unique, s.begin(), s.end())
+    template <class InputIterator>
+    front_coded_set(sorted_unique_t, InputIterator b, InputIterator e,
+                    size_type block_size = 16)
+     : n(0), block(block_size ? block_size : 1) {
+        build(b, e);
+        assert( ordered() );
+    }
+    template <typename base_type>
+    explicit front_coded_set(set_adapter<base_type> const &s,
+                             size_type block_size = 16)
+     : n(0), block(block_size ? block_size : 1) {
+        build(s.begin(), s.end());
+    }
+    // default copy ctr
+    // default destructor
+    // default assignment
+
+    // Iterators
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, n); }
+
+    // Capacity
+    bool empty() const { return n == 0; }
+    size_type size() const { return n; }
+    // Extra
+    size_type block_size() const { return block; }
+    // Bytes of heap in use
+    size_type storage_size() const {
+        return bytes.capacity() + offsets.capacity()*sizeof(size_type);
+    }
+    // Whether the strings are strictly increasing
+    bool ordered() const {
+        const_iterator it = begin(), prev = it;
+        if ( it == end() ) return true;
+        while ( ++it != end() ) {
+            if ( !(*prev < *it) ) return false;
+            prev = it;
+        }
+        return true;
+    }
+
+    // Modifiers
+    void swap(front_coded_set &other) {
+        bytes.swap(other.bytes);
+        offsets.swap(other.offsets);
+        std::swap( n, other.n );
+        std::swap( block, other.block );
+    }
+
+    // Observers
+    key_compare key_comp() const { return key_compare(); }
+    value_compare value_comp() const { return key_comp(); }
+
+    // Set operations
+    size_type count(const key_type &k) const { return contains(k); }
+    std::pair<const_iterator, const_iterator> equal_range(const key_type &k) const {
+        bool equal;
+        size_type const first = locate(k, false, equal);
+        return std::make_pair(const_iterator(this, first),
+                              const_iterator(this, first + equal));
+    }
+    const_iterator find(const key_type &k) const {
+        bool equal;
+        size_type const i = locate(k, false, equal);
+        return equal ? const_iterator(this, i) : end();
+    }
+    const_iterator lower_bound(const key_type &k) const {
+        bool equal;
+        return const_iterator(this, locate(k, false, equal));
+    }
+    const_iterator upper_bound(const key_type &k) const {
+        bool equal;
+        return const_iterator(this, locate(k, true, equal));
+    }
+    bool contains(const key_type &k) const {
+        bool equal;
+        locate(k, false, equal);
+        return equal;
+    }
+
+    // Comparison Operators
+    bool operator==(front_coded_set const &other) const {
+        return n == other.n && std::equal(begin(), end(), other.begin());
+    }
+    bool operator!=(front_coded_set const &other) const {
+        return !(*this == other);
+    }
+};
+
+// Overloaded Algorithms
+inline void swap(front_coded_set &lhs, front_coded_set &rhs) {
+    lhs.swap(rhs);
+}
+
+} // namespace assist
+
+#endif
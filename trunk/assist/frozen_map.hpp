@@ -0,0 +1,176 @@
+#ifndef ASSIST_FROZEN_MAP_HPP
+#define ASSIST_FROZEN_MAP_HPP
+
+/*
+ * assist/frozen_map.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* The map_adapter counterpart of frozen_set: a table sorted, checked
+ * and laid out by the compiler, for opcode maps and the like.
+ *
+ *     constexpr auto opcodes = make_frozen_map<std::string_view, int>({
+ *         { "add", 0x01 }, { "sub", 0x02 }, { "jmp", 0x10 } });
+ *     static_assert( opcodes.at("sub") == 0x02, "" );
+ *
+ * A duplicate key is a compile error, as is at() of a missing one in a
+ * constant expression.  The mapped values are fixed too; there's no
+ * operator[], since it would have to insert.
+ *
+ * Needs C++14 constexpr; without ASSIST_HAS_CXX14 this header is empty.
+ */
+
+#include "detail/config.hpp"
+
+#ifdef ASSIST_HAS_CXX14
+
+#include <utility> // pair, index_sequence
+#include <iterator> // reverse_iterator
+#include <functional> // less
+#include <stdexcept> // out_of_range
+#include <cstddef> // size_t, ptrdiff_t
+
+#include "detail/frozen.hpp"
+
+namespace assist {
+
+template < typename Key, typename T, std::size_t N,
+            typename CMP = std::less<Key> >
+class frozen_map {
+    static_assert( N != 0, "assist: a frozen_map needs at least one key" );
+
+  public:
+    // Types
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef std::pair<Key, T> value_type;
+    typedef CMP key_compare;
+    struct value_compare {
+        key_compare key_comparator;
+        constexpr value_compare(key_compare kcmp) : key_comparator(kcmp) {}
+        constexpr bool operator()(value_type const &lhs,
+                                  value_type const &rhs) const {
+            return key_comparator(lhs.first, rhs.first);
+        }
+        constexpr bool operator()(key_type const &lhs,
+                                  value_type const &rhs) const {
+            return key_comparator(lhs, rhs.first);
+        }
+        constexpr bool operator()(value_type const &lhs,
+                                  key_type const &rhs) const {
+            return key_comparator(lhs.first, rhs);
+        }
+    };
+    typedef value_type const &reference;
+    typedef value_type const &const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef value_type const *pointer;
+    typedef value_type const *const_pointer;
+    typedef value_type const *iterator;
+    typedef value_type const *const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  private:
+    typedef detail::frozen_first key_of;
+
+    key_compare comparator;
+    value_type items[N];
+
+    template < std::size_t... I >
+    constexpr frozen_map(value_type const (&init)[N], key_compare const &cmp,
+                         detail::index_array<N> const &order,
+                         std::index_sequence<I...>)
+     : comparator(cmp), items{ init[order[I]]... } {}
+
+  public:
+    // Construct/Copy/Destroy
+    // Sorts init by key; throws if two of its keys are equivalent
+    constexpr explicit frozen_map(value_type const (&init)[N],
+                                  key_compare const &cmp = key_compare())
+     : frozen_map(init, cmp,
+                  detail::sorted_order(init,
+                      detail::frozen_less<key_compare, key_of>(cmp)),
+                  std::make_index_sequence<N>()) {}
+    // default copy ctr
+    // default destructor
+    // default assignment
+
+    // Iterators
+    constexpr const_iterator begin() const { return items; }
+    constexpr const_iterator end() const { return items + N; }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    // Capacity
+    constexpr bool empty() const { return false; }
+    constexpr size_type size() const { return N; }
+    constexpr size_type max_size() const { return N; }
+
+    // Element Access
+    constexpr mapped_type const &at(const key_type &k) const {
+        const_iterator const it = find(k);
+        if ( it == end() ) throw std::out_of_range("assist: frozen_map::at");
+        return it->second;
+    }
+
+    // Observers
+    constexpr key_compare key_comp() const { return comparator; }
+    constexpr value_compare value_comp() const { return value_compare(comparator); }
+
+    // Set operations
+    constexpr size_type count(const key_type &k) const {
+        return contains(k) ? 1 : 0;
+    }
+    constexpr std::pair<const_iterator, const_iterator>
+    equal_range(const key_type &k) const {
+        return std::make_pair(lower_bound(k), upper_bound(k));
+    }
+    constexpr const_iterator find(const key_type &k) const {
+        const_iterator const it = lower_bound(k);
+        return it != end() && !comparator(k, it->first) ? it : end();
+    }
+    constexpr const_iterator lower_bound(const key_type &k) const {
+        return detail::fixed_partition_point(items, N,
+            detail::frozen_before_lower<key_compare, key_of, key_type>{
+                comparator, k });
+    }
+    constexpr const_iterator upper_bound(const key_type &k) const {
+        return detail::fixed_partition_point(items, N,
+            detail::frozen_before_upper<key_compare, key_of, key_type>{
+                comparator, k });
+    }
+    constexpr bool contains(const key_type &k) const {
+        return find(k) != end();
+    }
+
+    // Comparison Operators
+    constexpr bool operator==(frozen_map const &other) const {
+        for ( size_type i = 0; i != N; ++i ) {
+            if ( !(items[i] == other.items[i]) ) return false;
+        }
+        return true;
+    }
+    constexpr bool operator!=(frozen_map const &other) const {
+        return !(*this == other);
+    }
+};
+
+template < typename Key, typename T, std::size_t N,
+            typename CMP = std::less<Key> >
+constexpr frozen_map<Key, T, N, CMP>
+make_frozen_map(std::pair<Key, T> const (&items)[N], CMP const &cmp = CMP()) {
+    return frozen_map<Key, T, N, CMP>(items, cmp);
+}
+
+} // namespace assist
+
+#endif // ASSIST_HAS_CXX14
+
+#endif
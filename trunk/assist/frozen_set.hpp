@@ -0,0 +1,154 @@
+#ifndef ASSIST_FROZEN_SET_HPP
+#define ASSIST_FROZEN_SET_HPP
+
+/*
+ * assist/frozen_set.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* A set_adapter that's finished at compile time: the keys are sorted
+ * and checked for duplicates by the compiler, and a constexpr frozen_set
+ * goes in read-only data, with nothing to run at startup.
+ *
+ *     constexpr auto keywords = make_frozen_set<std::string_view>(
+ *         { "while", "if", "else", "for", "return" });
+ *     static_assert( keywords.contains("for"), "" );
+ *
+ * Any duplicate in the list is a compile error (or, built at run time,
+ * throws std::invalid_argument).  The lookups are constexpr too, and
+ * since the size is part of the type they're branch-free binary
+ * searches of a fixed number of steps, which the compiler can unroll
+ * and inline.  The comparator must be usable in constant expressions,
+ * as std::less is.
+ *
+ * Needs C++14 constexpr; without ASSIST_HAS_CXX14 this header is empty.
+ */
+
+#include "detail/config.hpp"
+
+#ifdef ASSIST_HAS_CXX14
+
+#include <utility> // pair, index_sequence
+#include <iterator> // reverse_iterator
+#include <functional> // less
+#include <cstddef> // size_t, ptrdiff_t
+
+#include "detail/frozen.hpp"
+
+namespace assist {
+
+template < typename Key, std::size_t N, typename CMP = std::less<Key> >
+class frozen_set {
+    static_assert( N != 0, "assist: a frozen_set needs at least one key" );
+
+  public:
+    // Types
+    typedef Key key_type;
+    typedef key_type value_type;
+    typedef CMP key_compare;
+    typedef key_compare value_compare;
+    typedef value_type const &reference;
+    typedef value_type const &const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef value_type const *pointer;
+    typedef value_type const *const_pointer;
+    typedef value_type const *iterator;
+    typedef value_type const *const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  private:
+    typedef detail::frozen_identity key_of;
+
+    key_compare comparator;
+    value_type items[N];
+
+    template < std::size_t... I >
+    constexpr frozen_set(value_type const (&init)[N], key_compare const &cmp,
+                         detail::index_array<N> const &order,
+                         std::index_sequence<I...>)
+     : comparator(cmp), items{ init[order[I]]... } {}
+
+  public:
+    // Construct/Copy/Destroy
+    // Sorts init; throws if two of its keys are equivalent
+    constexpr explicit frozen_set(value_type const (&init)[N],
+                                  key_compare const &cmp = key_compare())
+     : frozen_set(init, cmp,
+                  detail::sorted_order(init,
+                      detail::frozen_less<key_compare, key_of>(cmp)),
+                  std::make_index_sequence<N>()) {}
+    // default copy ctr
+    // default destructor
+    // default assignment
+
+    // Iterators
+    constexpr const_iterator begin() const { return items; }
+    constexpr const_iterator end() const { return items + N; }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    // Capacity
+    constexpr bool empty() const { return false; }
+    constexpr size_type size() const { return N; }
+    constexpr size_type max_size() const { return N; }
+
+    // Observers
+    constexpr key_compare key_comp() const { return comparator; }
+    constexpr value_compare value_comp() const { return comparator; }
+
+    // Set operations
+    constexpr size_type count(const key_type &k) const {
+        return contains(k) ? 1 : 0;
+    }
+    constexpr std::pair<const_iterator, const_iterator>
+    equal_range(const key_type &k) const {
+        return std::make_pair(lower_bound(k), upper_bound(k));
+    }
+    constexpr const_iterator find(const key_type &k) const {
+        const_iterator const it = lower_bound(k);
+        return it != end() && !comparator(k, *it) ? it : end();
+    }
+    constexpr const_iterator lower_bound(const key_type &k) const {
+        return detail::fixed_partition_point(items, N,
+            detail::frozen_before_lower<key_compare, key_of, key_type>{
+                comparator, k });
+    }
+    constexpr const_iterator upper_bound(const key_type &k) const {
+        return detail::fixed_partition_point(items, N,
+            detail::frozen_before_upper<key_compare, key_of, key_type>{
+                comparator, k });
+    }
+    constexpr bool contains(const key_type &k) const {
+        return find(k) != end();
+    }
+
+    // Comparison Operators
+    constexpr bool operator==(frozen_set const &other) const {
+        for ( size_type i = 0; i != N; ++i ) {
+            if ( !(items[i] == other.items[i]) ) return false;
+        }
+        return true;
+    }
+    constexpr bool operator!=(frozen_set const &other) const {
+        return !(*this == other);
+    }
+};
+
+template < typename Key, std::size_t N, typename CMP = std::less<Key> >
+constexpr frozen_set<Key, N, CMP> make_frozen_set(Key const (&keys)[N],
+                                                  CMP const &cmp = CMP()) {
+    return frozen_set<Key, N, CMP>(keys, cmp);
+}
+
+} // namespace assist
+
+#endif // ASSIST_HAS_CXX14
+
+#endif
@@ -0,0 +1,297 @@
+#ifndef ASSIST_LEARNED_INDEX_HPP
+#define ASSIST_LEARNED_INDEX_HPP
+
+/*
+ * assist/learned_index.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* A learned lookup index for any of the sorted adapters with numeric
+ * keys.  The position of each distinct key is fitted by a piecewise
+ * linear model, every segment keeping within epsilon of the true
+ * position, so a search finds the segment, predicts a position and
+ * binary searches only the 2*epsilon elements around it.
+ *
+ * The prediction is always checked against the neighbouring elements,
+ * and if it's off (keys between fitted points, long runs of equivalent
+ * keys in the multi adapters) the search gallops outwards from it, so
+ * results are exactly those of the adapter's own searches.
+ *
+ * Keys are converted to double for the model, and the comparator must
+ * order them the way < orders those doubles.
+ *
+ * WARNING: Any modification of the adapter invalidates the index;
+ * call rebuild() afterwards, as you would re-fetch an iterator.
+ */
+
+#include <vector>
+#include <utility> // pair
+#include <algorithm> // upper_bound
+#include <limits> // numeric_limits
+#include <cstddef> // size_t
+
+#include "detail/config.hpp"
+#include "detail/key_extractor.hpp"
+
+namespace assist {
+
+namespace detail {
+
+// First element in [b,e) for which before is false; before must be
+// true for a prefix of the range and false for the rest.
+template < typename RandomIterator, typename Predicate >
+RandomIterator partition_point(RandomIterator b, RandomIterator e,
+                               Predicate before) {
+    while ( b != e ) {
+        RandomIterator const m = b + (e-b)/2;
+        if ( before(*m) ) {
+            b = m+1;
+        } else {
+            e = m;
+        }
+    }
+    return b;
+}
+
+// The elements before lower_bound(k), and before upper_bound(k)
+template < typename CMP, typename key_type, typename value_type >
+struct before_lower_bound {
+    CMP comparator;
+    key_type const &k;
+    before_lower_bound(CMP cmp, key_type const &key)
+     : comparator(cmp), k(key) {}
+    bool operator()(value_type const &v) const {
+        return comparator(key_extractor<key_type, value_type>()(v), k);
+    }
+};
+template < typename CMP, typename key_type, typename value_type >
+struct before_upper_bound {
+    CMP comparator;
+    key_type const &k;
+    before_upper_bound(CMP cmp, key_type const &key)
+     : comparator(cmp), k(key) {}
+    bool operator()(value_type const &v) const {
+        return !comparator(k, key_extractor<key_type, value_type>()(v));
+    }
+};
+
+} // namespace detail
+
+template < typename adapter_type >
+class learned_index {
+  public:
+    // Types
+    typedef adapter_type adapter;
+    typedef typename adapter_type::key_type key_type;
+    typedef typename adapter_type::value_type value_type;
+    typedef typename adapter_type::key_compare key_compare;
+    typedef typename adapter_type::value_compare value_compare;
+    typedef typename adapter_type::size_type size_type;
+    typedef typename adapter_type::difference_type difference_type;
+    typedef typename adapter_type::const_iterator const_iterator;
+
+  private:
+    struct segment {
+        double slope;
+        // position of firsts[i]
+        double start;
+    };
+
+    adapter_type const *a;
+    // the first key of each segment, searched to pick one
+    std::vector<key_type> firsts;
+    std::vector<segment> segments;
+    size_type epsilon;
+    size_type worst;
+    key_compare comparator;
+    detail::key_extractor<key_type, value_type> key_of;
+
+    static double x(key_type const &k) { return static_cast<double>(k); }
+    key_type key(size_type i) const {
+        return key_of(a->begin()[i]);
+    }
+    // Position after the run of keys equivalent to the one at i
+    size_type skip_run(size_type i) const {
+        key_type const k = key(i);
+        size_type const n = a->size();
+        while ( ++i != n && !comparator(k, key(i)) ) {}
+        return i;
+    }
+
+    // Shrinking cone: each segment is anchored at its first point and
+    // takes points for as long as some slope keeps all within epsilon.
+    void fit() {
+        size_type const n = a->size();
+        double const eps = double(epsilon);
+        for ( size_type i = 0; i != n; ) {
+            double const x0 = x(key(i)), y0 = double(i);
+            double lo = 0, hi = std::numeric_limits<double>::max();
+            size_type j = skip_run(i);
+            for ( ; j != n; j = skip_run(j) ) {
+                double const dx = x(key(j)) - x0, dy = double(j) - y0;
+                if ( dx <= 0 ) {
+                    // too close to tell apart as doubles
+                    if ( dy > eps ) break;
+                    continue;
+                }
+                double const l = (dy-eps)/dx, h = (dy+eps)/dx;
+                if ( l > hi || h < lo ) break;
+                if ( l > lo ) lo = l;
+                if ( h < hi ) hi = h;
+            }
+            segment const s = {
+                hi == std::numeric_limits<double>::max() ? 0 : (lo+hi)/2, y0
+            };
+            firsts.push_back(key(i));
+            segments.push_back(s);
+            i = j;
+        }
+    }
+    size_type predict(key_type const &k) const {
+        typename std::vector<key_type>::const_iterator const it =
+            std::upper_bound(firsts.begin(), firsts.end(), k, comparator);
+        if ( it == firsts.begin() ) return 0;
+        size_type const i = it - firsts.begin() - 1;
+        double const p = segments[i].start
+                         + segments[i].slope * (x(k) - x(firsts[i]));
+        double const n = double(a->size());
+        // !(p > 0) also catches the NaN of an infinite key on a flat
+        // segment, which converting would make undefined
+        return size_type( !(p > 0) ? 0 : p > n ? n : p );
+    }
+
+    // The partition point of before, searching out from the prediction
+    template < typename Predicate >
+    const_iterator search(key_type const &k, Predicate before) const {
+        const_iterator const b = a->begin();
+        size_type const n = a->size(), p = predict(k);
+        size_type lo = p > epsilon ? p-epsilon : 0;
+        size_type hi = p+epsilon+1 < n ? p+epsilon+1 : n;
+        if ( lo != 0 && !before(b[lo-1]) ) {
+            // it's left of the window: gallop down from lo-1
+            size_type r = lo-1, d = 1;
+            while ( d <= r && !before(b[r-d]) ) {
+                r -= d;
+                d <<= 1;
+            }
+            hi = r;
+            lo = d <= r ? r-d+1 : 0;
+        } else if ( hi != n && before(b[hi]) ) {
+            // it's right of the window: gallop up from hi
+            size_type l = hi, d = 1;
+            while ( l+d < n && before(b[l+d]) ) {
+                l += d;
+                d <<= 1;
+            }
+            lo = l+1;
+            hi = l+d < n ? l+d : n;
+        }
+        return detail::partition_point(b+lo, b+hi, before);
+    }
+
+  public:
+    // Construct/Copy/Destroy
+    explicit learned_index(adapter_type const &c, size_type max_error = 32)
+     : a(&c), epsilon(max_error), worst(0), comparator(c.key_comp()) {
+        rebuild();
+    }
+    // default copy ctr
+    // default destructor
+    // default assignment
+
+    // Refits the model to the adapter's current contents.
+    void rebuild() {
+        firsts.clear();
+        segments.clear();
+        fit();
+        std::vector<key_type>(firsts).swap(firsts);
+        std::vector<segment>(segments).swap(segments);
+        worst = 0;
+        for ( size_type i = 0, n = a->size(); i != n; i = skip_run(i) ) {
+            size_type const p = predict(key(i));
+            size_type const e = p > i ? p-i : i-p;
+            if ( e > worst ) worst = e;
+        }
+    }
+
+    adapter_type const &base() const { return *a; }
+
+    // Capacity
+    bool empty() const { return a->empty(); }
+    size_type size() const { return a->size(); }
+    // Extra
+    size_type segment_count() const { return segments.size(); }
+    // Bytes of heap the model takes
+    size_type model_size() const {
+        return firsts.capacity()*sizeof(key_type)
+             + segments.capacity()*sizeof(segment);
+    }
+    // The error bound asked for, and the largest error actually seen
+    // for a key present in the adapter (predictions are rounded down,
+    // so this can be one more than max_error()).
+    size_type max_error() const { return epsilon; }
+    size_type measured_error() const { return worst; }
+
+    // Observers
+    key_compare key_comp() const { return comparator; }
+    value_compare value_comp() const { return a->value_comp(); }
+
+    // Set operations
+    size_type count(const key_type &k) const {
+        std::pair<const_iterator, const_iterator> edges = equal_range(k);
+        return edges.second-edges.first;
+    }
+    std::pair<const_iterator, const_iterator> equal_range(const key_type &k) const {
+        return std::make_pair(lower_bound(k), upper_bound(k));
+    }
+    const_iterator find(const key_type &k) const {
+        const_iterator const it = lower_bound(k);
+        if ( it == a->end() || comparator(k, key_of(*it)) ) {
+            return a->end();
+        } else {
+            return it;
+        }
+    }
+    const_iterator lower_bound(const key_type &k) const {
+        return search(k, detail::before_lower_bound<key_compare, key_type, value_type>(
+                             comparator, k));
+    }
+    const_iterator upper_bound(const key_type &k) const {
+        return search(k, detail::before_upper_bound<key_compare, key_type, value_type>(
+                             comparator, k));
+    }
+    bool contains(const key_type &k) const {
+        const_iterator const it = lower_bound(k);
+        return it != a->end() && !comparator(k, key_of(*it));
+    }
+
+    void swap(learned_index &other) {
+        std::swap( a, other.a );
+        std::swap( epsilon, other.epsilon );
+        std::swap( worst, other.worst );
+        std::swap( comparator, other.comparator );
+        firsts.swap(other.firsts);
+        segments.swap(other.segments);
+    }
+};
+
+template < typename adapter_type >
+learned_index<adapter_type> make_learned_index(adapter_type const &c) {
+    return learned_index<adapter_type>(c);
+}
+
+// Overloaded Algorithms
+template < typename adapter_type >
+void swap(learned_index<adapter_type> &lhs,
+          learned_index<adapter_type> &rhs) {
+    lhs.swap(rhs);
+}
+
+} // namespace assist
+
+#endif
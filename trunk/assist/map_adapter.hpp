@@ -12,12 +12,19 @@
  */
 
 #include "set_adapter.hpp"
+#include "detail/batch_search.hpp"
+#include "detail/adapter_traits.hpp"
+
+#ifdef ASSIST_HAS_CXX11
+#include <tuple> // forward_as_tuple
+#endif
 
 namespace assist {
 
 template < typename base_type,
             typename CMP = std::less<typename base_type::value_type
-                                                         ::first_type> >
+                                                         ::first_type>,
+            typename Stats = no_stats >
 class map_adapter {
   public:
     // Types
@@ -40,13 +47,37 @@ class map_adapter {
                          key_type const &rhs) const {
             return key_comparator(lhs.first, rhs);
         }
+        // for sorting batches of keys
+        bool operator()(key_type const &lhs,
+                         key_type const &rhs) const {
+            return key_comparator(lhs, rhs);
+        }
+#ifdef ASSIST_HAS_CXX11
+        template <typename K>
+        bool operator()(K const &lhs, value_type const &rhs) const {
+            return key_comparator(lhs, rhs.first);
+        }
+        template <typename K>
+        bool operator()(value_type const &lhs, K const &rhs) const {
+            return key_comparator(lhs.first, rhs);
+        }
+#endif
     };
 
   private:
-    typedef set_adapter< base_type, value_compare > set_type; 
+    typedef set_adapter< base_type, value_compare, Stats > set_type; 
 //    typedef std::set< value_type, value_compare, typename base_type::allocator_type > set_type; 
     set_type c;
     // c holds the comparator
+    // value_comp(), counting calls if Stats does
+    typedef detail::stats_compare<value_compare, Stats> compare_source;
+    typedef typename compare_source::type compare_type;
+
+    // c's counters are mutable
+    Stats &counters() const { return const_cast<Stats &>(c.stats()); }
+    compare_type compare() const {
+        return compare_source::get(value_comp(), counters());
+    }
 
   public:
     // Types
@@ -63,6 +94,41 @@ class map_adapter {
     typedef typename set_type::const_reverse_iterator const_reverse_iterator;
 //    typedef typename set_type:: ;
 
+  private:
+    // lower_bound(k), searching out from hint
+    iterator locate(iterator hint, const key_type &k) {
+        detail::lookup_probe<Stats> probe(counters());
+        return detail::finger_lower_bound(begin(), end(), hint, k,
+                                          compare());
+    }
+#ifdef ASSIST_HAS_CXX11
+    // it is lower_bound(k)
+    template <class K, class... Args>
+    std::pair<iterator, bool> try_emplace_at(iterator it, K &&k,
+                                             Args &&...args) {
+        if ( it != end() && !compare()(k, *it) ) {
+            return std::make_pair(it, false);
+        }
+        it = c.insert(it, value_type(std::piecewise_construct,
+                              std::forward_as_tuple(std::forward<K>(k)),
+                              std::forward_as_tuple(
+                                  std::forward<Args>(args)...)));
+        return std::make_pair(it, true);
+    }
+    template <class K, class M>
+    std::pair<iterator, bool> insert_or_assign_at(iterator it, K &&k,
+                                                  M &&m) {
+        if ( it != end() && !compare()(k, *it) ) {
+            it->second = std::forward<M>(m);
+            return std::make_pair(it, false);
+        }
+        it = c.insert(it, value_type(std::forward<K>(k),
+                                     std::forward<M>(m)));
+        return std::make_pair(it, true);
+    }
+#endif
+
+  public:
     // Construct/Copy/Destroy
     explicit map_adapter(const key_compare &cmp = key_compare(), 
                           const allocator_type &alloc = allocator_type ())
@@ -72,6 +138,16 @@ class map_adapter {
                 const key_compare &cmp = key_compare(), 
                 const allocator_type &alloc = allocator_type ())
      : c(b, e, cmp, alloc) {}
+    template <class InputIterator>
+    map_adapter(parallel_t p, InputIterator b, InputIterator e, 
+                const key_compare &cmp = key_compare(), 
+                const allocator_type &alloc = allocator_type ())
+     : c(p, b, e, cmp, alloc) {}
+    template <class InputIterator>
+    map_adapter(sorted_unique_t t, InputIterator b, InputIterator e, 
+                const key_compare &cmp = key_compare(), 
+                const allocator_type &alloc = allocator_type ())
+     : c(t, b, e, cmp, alloc) {}
     // default copy ctr
     // default destructor
     // default assignment
@@ -83,6 +159,21 @@ class map_adapter {
         c = b;
         return *this;
     }
+    map_adapter(sorted_unique_t t, base_type const &b,
+                          const key_compare &cmp = key_compare())
+     : c(t,b,cmp) {}
+#ifdef ASSIST_HAS_CXX11
+    explicit map_adapter(base_type &&b,
+                          const key_compare &cmp = key_compare())
+     : c(std::move(b),cmp) {}
+    map_adapter &operator=(base_type &&b) {
+        c = std::move(b);
+        return *this;
+    }
+    map_adapter(sorted_unique_t t, base_type &&b,
+                          const key_compare &cmp = key_compare())
+     : c(t,std::move(b),cmp) {}
+#endif
 
     set_type const &set() const { return c; }
     base_type const &base() const { return c.base(); }
@@ -104,6 +195,8 @@ class map_adapter {
     // Extra
     size_type capacity() const { return c.capacity(); }
     void reserve(size_type n) { return c.reserve(n); }
+    // Gives back the capacity left over after erasing
+    void shrink_to_fit() { c.shrink_to_fit(); }
 
     // Modifiers
     std::pair<iterator, bool> insert(const value_type &v) {
@@ -112,13 +205,96 @@ class map_adapter {
     iterator insert(iterator hint, const value_type &v) {
         return c.insert(hint, v);
     }
+#ifdef ASSIST_HAS_CXX11
+    std::pair<iterator, bool> insert(value_type &&v) {
+        return c.insert(std::move(v));
+    }
+    iterator insert(iterator hint, value_type &&v) {
+        return c.insert(hint, std::move(v));
+    }
+    template <class... Args>
+    std::pair<iterator, bool> emplace(Args &&...args) {
+        return c.emplace(std::forward<Args>(args)...);
+    }
+    template <class... Args>
+    iterator emplace_hint(iterator hint, Args &&...args) {
+        return c.emplace_hint(hint, std::forward<Args>(args)...);
+    }
+    // The mapped value is only constructed if k is not already present
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(const key_type &k, Args &&...args) {
+        return try_emplace_at(lower_bound(k), k, std::forward<Args>(args)...);
+    }
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(key_type &&k, Args &&...args) {
+        iterator const it = lower_bound(k);
+        return try_emplace_at(it, std::move(k), std::forward<Args>(args)...);
+    }
+    template <class... Args>
+    iterator try_emplace(iterator hint, const key_type &k, Args &&...args) {
+        return try_emplace_at(locate(hint, k), k,
+                              std::forward<Args>(args)...).first;
+    }
+    template <class... Args>
+    iterator try_emplace(iterator hint, key_type &&k, Args &&...args) {
+        iterator const it = locate(hint, k);
+        return try_emplace_at(it, std::move(k),
+                              std::forward<Args>(args)...).first;
+    }
+    template <class M>
+    std::pair<iterator, bool> insert_or_assign(const key_type &k, M &&m) {
+        return insert_or_assign_at(lower_bound(k), k, std::forward<M>(m));
+    }
+    template <class M>
+    std::pair<iterator, bool> insert_or_assign(key_type &&k, M &&m) {
+        iterator const it = lower_bound(k);
+        return insert_or_assign_at(it, std::move(k), std::forward<M>(m));
+    }
+    template <class M>
+    iterator insert_or_assign(iterator hint, const key_type &k, M &&m) {
+        return insert_or_assign_at(locate(hint, k), k,
+                                   std::forward<M>(m)).first;
+    }
+    template <class M>
+    iterator insert_or_assign(iterator hint, key_type &&k, M &&m) {
+        iterator const it = locate(hint, k);
+        return insert_or_assign_at(it, std::move(k),
+                                   std::forward<M>(m)).first;
+    }
+#endif
     template <class InputIterator>
     void insert(InputIterator b, InputIterator const e) {
         return c.insert(b,e);
     }
+    template <class InputIterator>
+    void insert(parallel_t p, InputIterator b, InputIterator const e) {
+        return c.insert(p,b,e);
+    }
     void erase(iterator it) { c.erase(it); }
-    size_type erase(const key_type &k) { c.erase(k); }
+    size_type erase(const key_type &k) {
+        iterator const it = find(k);
+        if ( it == end() ) return 0;
+        c.erase(it);
+        return 1;
+    }
     void erase(iterator b, iterator e) { c.erase(b, e); }
+    // Bulk removal, compacting in one pass; each returns how many
+    // elements were removed.
+    template <class Predicate>
+    size_type erase_if(Predicate pred) { return c.erase_if(pred); }
+    template <class Predicate>
+    size_type retain_if(Predicate pred) { return c.retain_if(pred); }
+    // Removes every element with one of the keys [b,e).
+    // Keys in order are swept in one pass; others are sorted first.
+    template <class ForwardIterator>
+    size_type erase_keys(ForwardIterator b, ForwardIterator e) {
+        return c.erase_keys(b, e);
+    }
+    // ...or every element that doesn't have one
+    template <class ForwardIterator>
+    size_type retain_keys(ForwardIterator b, ForwardIterator e) {
+        return c.retain_keys(b, e);
+    }
     void swap(map_adapter &other) {
         using namespace std;
         c.swap(other.c); // swap( c, other.c );
@@ -130,54 +306,179 @@ class map_adapter {
         using namespace std;
         c.swap(other); // swap( c, other.c );
     }
+    void swap(parallel_t p, base_type &other) {
+        c.swap(p, other);
+    }
+    void swap(sorted_unique_t t, base_type &other) {
+        c.swap(t, other);
+    }
+#ifdef ASSIST_HAS_CXX11
+    void adopt(sorted_unique_t t, base_type &&b) {
+        c.adopt(t, std::move(b));
+    }
+#endif
 
     // Observers
     value_compare value_comp() const { return c.value_comp(); }
     key_compare key_comp() const { return value_comp().key_comparator; }
+    // Extra
+    Stats const &stats() const { return c.stats(); }
+    Stats &stats() { return c.stats(); }
 
     // map operations
     mapped_type &operator[](const key_type &k) {
-        return insert(value_type(k,mapped_type())).first->second;
+        iterator it = lower_bound(k);
+        if ( it == end() || compare()(k, *it) ) {
+            it = c.insert(it, value_type(k,mapped_type()));
+        }
+        return it->second;
     }
+#ifdef ASSIST_HAS_CXX11
+    mapped_type &operator[](key_type &&k) {
+        return try_emplace(std::move(k)).first->second;
+    }
+#endif
     size_type count(const key_type &k) const {
         return contains(k)?1:0;
     }
     std::pair<iterator, iterator> equal_range(const key_type &k) {
-        return std::equal_range(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return std::equal_range(begin(), end(), k, compare());
     }
     std::pair<const_iterator, const_iterator> equal_range(const key_type &k) const {
-        return std::equal_range(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return std::equal_range(begin(), end(), k, compare());
     }
     iterator find(const key_type &k) {
-        iterator it = lower_bound(k);
-        if ( it == end() || comparator(k, *it) ) {
+        detail::lookup_probe<Stats> probe(counters());
+        iterator it = std::lower_bound(begin(), end(), k, compare());
+        if ( it == end() || compare()(k, *it) ) {
             return end();
         } else {
             return it;
         }
     }
     const_iterator find(const key_type &k) const {
-        const_iterator it = lower_bound(k);
-        if ( it == end() || comparator(k, *it) ) {
+        detail::lookup_probe<Stats> probe(counters());
+        const_iterator it = std::lower_bound(begin(), end(), k, compare());
+        if ( it == end() || compare()(k, *it) ) {
             return end();
         } else {
             return it;
         }
     }
     iterator lower_bound(const key_type &k) {
-        return std::lower_bound(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return std::lower_bound(begin(), end(), k, compare());
     }
     const_iterator lower_bound(const key_type &k) const {
-        return std::lower_bound(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return std::lower_bound(begin(), end(), k, compare());
     }
     iterator upper_bound(const key_type &k) {
-        return std::upper_bound(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return std::upper_bound(begin(), end(), k, compare());
     }
     const_iterator upper_bound(const key_type &k) const {
-        return std::upper_bound(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return std::upper_bound(begin(), end(), k, compare());
     }
     bool contains(const key_type &k) const {
-        return std::binary_search(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return std::binary_search(begin(), end(), k, compare());
+    }
+#ifdef ASSIST_HAS_CXX11
+    // Heterogeneous lookup, for comparators declaring is_transparent
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    size_type count(const K &k) const {
+        return contains(k)?1:0;
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K &k) {
+        detail::lookup_probe<Stats> probe(counters());
+        return std::equal_range(begin(), end(), k, compare());
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    std::pair<const_iterator, const_iterator> equal_range(const K &k) const {
+        detail::lookup_probe<Stats> probe(counters());
+        return std::equal_range(begin(), end(), k, compare());
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    iterator find(const K &k) {
+        detail::lookup_probe<Stats> probe(counters());
+        iterator it = std::lower_bound(begin(), end(), k, compare());
+        return ( it == end() || compare()(k, *it) ) ? end() : it;
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    const_iterator find(const K &k) const {
+        detail::lookup_probe<Stats> probe(counters());
+        const_iterator it = std::lower_bound(begin(), end(), k, compare());
+        return ( it == end() || compare()(k, *it) ) ? end() : it;
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    iterator lower_bound(const K &k) {
+        detail::lookup_probe<Stats> probe(counters());
+        return std::lower_bound(begin(), end(), k, compare());
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    const_iterator lower_bound(const K &k) const {
+        detail::lookup_probe<Stats> probe(counters());
+        return std::lower_bound(begin(), end(), k, compare());
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    iterator upper_bound(const K &k) {
+        detail::lookup_probe<Stats> probe(counters());
+        return std::upper_bound(begin(), end(), k, compare());
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    const_iterator upper_bound(const K &k) const {
+        detail::lookup_probe<Stats> probe(counters());
+        return std::upper_bound(begin(), end(), k, compare());
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    bool contains(const K &k) const {
+        detail::lookup_probe<Stats> probe(counters());
+        return std::binary_search(begin(), end(), k, compare());
+    }
+#endif
+    // Extra
+    // Batched lookups, writing one result per key in input order.
+    // Sorted batches take a single galloping sweep; others are
+    // searched a group at a time with their probes prefetched.
+    template <class ForwardIterator, class OutputIterator>
+    OutputIterator lower_bound_many(ForwardIterator b, ForwardIterator e,
+                                    OutputIterator out) const {
+        return detail::batch_lower_bound(begin(), end(), b, e,
+                   key_comp(), compare(),
+                   detail::store_lower_bound<OutputIterator>(out)).out;
+    }
+    template <class ForwardIterator, class OutputIterator>
+    OutputIterator find_many(ForwardIterator b, ForwardIterator e,
+                             OutputIterator out) const {
+        typedef detail::store_find<OutputIterator, const_iterator,
+                                   compare_type> visitor;
+        return detail::batch_lower_bound(begin(), end(), b, e,
+                   key_comp(), compare(),
+                   visitor(out, end(), compare())).out;
+    }
+    template <class ForwardIterator, class OutputIterator>
+    OutputIterator contains_many(ForwardIterator b, ForwardIterator e,
+                                 OutputIterator out) const {
+        typedef detail::store_contains<OutputIterator, const_iterator,
+                                       compare_type> visitor;
+        return detail::batch_lower_bound(begin(), end(), b, e,
+                   key_comp(), compare(),
+                   visitor(out, end(), compare())).out;
     }
   
     // Comparison Operators
@@ -189,22 +490,29 @@ class map_adapter {
     bool operator>=(map_adapter const &other) { return c >= other.c; }
 };
 
+namespace detail {
+template < typename base_type, typename CMP, typename Stats >
+struct is_unique_adapter< map_adapter<base_type, CMP, Stats> > {
+    static bool const value = true;
+};
+} // namespace detail
+
 // Overloaded Algorithms
 template < typename base_type,
-            typename CMP >
-void swap(map_adapter<base_type,CMP> const &lhs,
-          map_adapter<base_type,CMP> const &rhs) {
+            typename CMP, typename Stats >
+void swap(map_adapter<base_type,CMP,Stats> const &lhs,
+          map_adapter<base_type,CMP,Stats> const &rhs) {
     lhs.swap(rhs);
 }
 template < typename base_type,
-            typename CMP >
+            typename CMP, typename Stats >
 void swap(base_type const &lhs,
-          map_adapter<base_type,CMP> const &rhs) {
+          map_adapter<base_type,CMP,Stats> const &rhs) {
     lhs.swap(rhs);
 }
 template < typename base_type,
-            typename CMP >
-void swap(map_adapter<base_type,CMP> const &lhs,
+            typename CMP, typename Stats >
+void swap(map_adapter<base_type,CMP,Stats> const &lhs,
           base_type const &rhs) {
     lhs.swap(rhs);
 }
@@ -216,20 +524,20 @@ namespace std {
 
 // Overloaded Algorithms
 template < typename base_type,
-            typename CMP >
-void swap(assist::map_adapter<base_type,CMP> const &lhs,
-          assist::map_adapter<base_type,CMP> const &rhs) {
+            typename CMP, typename Stats >
+void swap(assist::map_adapter<base_type,CMP,Stats> const &lhs,
+          assist::map_adapter<base_type,CMP,Stats> const &rhs) {
     assist::swap(lhs,rhs);
 }
 template < typename base_type,
-            typename CMP >
+            typename CMP, typename Stats >
 void swap(base_type const &lhs,
-          assist::map_adapter<base_type,CMP> const &rhs) {
+          assist::map_adapter<base_type,CMP,Stats> const &rhs) {
     assist::swap(lhs,rhs);
 }
 template < typename base_type,
-            typename CMP >
-void swap(assist::map_adapter<base_type,CMP> const &lhs,
+            typename CMP, typename Stats >
+void swap(assist::map_adapter<base_type,CMP,Stats> const &lhs,
           base_type const &rhs) {
     assist::swap(lhs,rhs);
 }
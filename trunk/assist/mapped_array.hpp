@@ -0,0 +1,240 @@
+#ifndef ASSIST_MAPPED_ARRAY_HPP
+#define ASSIST_MAPPED_ARRAY_HPP
+
+/*
+ * assist/mapped_array.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* A read-only base_type backed by a memory-mapped file, so that a
+ * sorted dictionary written once can be opened without reading it in,
+ * paged in as it's searched, and shared between processes:
+ *
+ *     write_mapped_array("words.dat", m);
+ *     map_adapter< mapped_array<entry> > d(sorted_unique,
+ *                                         mapped_array<entry>("words.dat"));
+ *
+ * The file is a 64 byte header (magic, element size, count and an
+ * FNV-1a checksum of the records) followed by the raw records, in the
+ * writer's byte order.  Opening checks everything but the checksum,
+ * which would read the whole file; call verify() for that.
+ *
+ * Only the const parts of the adapters can be used on top of this,
+ * and value_type must be plain data: no pointers, nothing to destroy.
+ * Copies are cheap; they all share the one mapping.
+ */
+
+#include <cstddef> // size_t, ptrdiff_t
+#include <cstring> // memcmp, memcpy
+#include <string>
+#include <fstream>
+#include <iterator> // reverse_iterator, iterator_traits
+#include <algorithm> // equal, lexicographical_compare
+#include <functional> // less
+#include <memory> // allocator
+#include <stdexcept> // runtime_error
+
+#include "detail/config.hpp"
+#include "detail/file_mapping.hpp"
+#include "detail/sorted_search.hpp"
+
+#ifdef ASSIST_HAS_CXX11
+#include <type_traits>
+#endif
+
+namespace assist {
+
+namespace detail {
+
+// Leads every mapped_array file
+struct mapped_array_header {
+    char magic[8];
+    unsigned long long element_size;
+    unsigned long long count;
+    unsigned long long checksum;
+};
+// Last byte is the format version
+char const mapped_array_magic[8] = { 'a','s','s','i','s','t','M', 1 };
+// The records start here, so they're cache line aligned in the mapping
+std::size_t const mapped_array_offset = 64;
+
+unsigned long long const fnv1a_basis = 0xcbf29ce484222325ULL;
+inline unsigned long long fnv1a(unsigned long long h,
+                                void const *p, std::size_t n) {
+    unsigned char const *b = static_cast<unsigned char const *>(p);
+    for ( std::size_t i = 0; i != n; ++i ) {
+        h = (h ^ b[i]) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+} // namespace detail
+
+template < typename T >
+class mapped_array {
+#ifdef ASSIST_HAS_CXX11
+    static_assert(std::is_trivially_copy_constructible<T>::value &&
+                  std::is_trivially_destructible<T>::value,
+                  "mapped_array elements must be plain data");
+#endif
+    detail::file_mapping file;
+    T const *first;
+    std::size_t n;
+
+    static void fail(char const *path) {
+        throw std::runtime_error(std::string("assist: ") + path +
+                                 " is not a mapped_array of this type");
+    }
+    detail::mapped_array_header const &header() const {
+        return *reinterpret_cast<detail::mapped_array_header const *>(
+                    file.data());
+    }
+
+  public:
+    // Types
+    typedef T value_type;
+    typedef std::allocator<T> allocator_type;
+    typedef T const &reference;
+    typedef T const &const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef T const *pointer;
+    typedef T const *const_pointer;
+    typedef T const *iterator;
+    typedef T const *const_iterator;
+    typedef std::reverse_iterator<const_iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    // Construct/Copy/Destroy
+    mapped_array() : first(0), n(0) {}
+    // Throws std::runtime_error if path can't be mapped, or doesn't
+    // hold an array of T written by write_mapped_array.
+    explicit mapped_array(char const *path)
+     : file(path), first(0), n(0) {
+        std::size_t const offset = detail::mapped_array_offset;
+        if ( file.size() < offset ||
+             std::memcmp(header().magic, detail::mapped_array_magic,
+                         sizeof(detail::mapped_array_magic)) != 0 ||
+             header().element_size != sizeof(T) ||
+             header().count != (file.size()-offset)/sizeof(T) ||
+             (file.size()-offset)%sizeof(T) != 0 ) {
+            fail(path);
+        }
+        first = reinterpret_cast<T const *>(file.data() + offset);
+        n = std::size_t(header().count);
+    }
+    explicit mapped_array(std::string const &path)
+     : file(), first(0), n(0) {
+        mapped_array(path.c_str()).swap(*this);
+    }
+    // default copy ctr
+    // default destructor
+    // default assignment
+
+    // Iterators
+    const_iterator begin() const { return first; }
+    const_iterator end() const { return first+n; }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    // Capacity
+    bool empty() const { return n == 0; }
+    size_type size() const { return n; }
+
+    // Element Access
+    const_reference operator[](size_type i) const { return first[i]; }
+    const_reference front() const { return first[0]; }
+    const_reference back() const { return first[n-1]; }
+    const_pointer data() const { return first; }
+
+    // Extra
+    // Recomputes the checksum, reading the whole file in to do so
+    bool verify() const {
+        if ( !file.data() ) return true;
+        return detail::fnv1a(detail::fnv1a_basis, first, n*sizeof(T))
+               == header().checksum;
+    }
+
+    void swap(mapped_array &other) {
+        file.swap(other.file);
+        std::swap( first, other.first );
+        std::swap( n, other.n );
+    }
+
+    // Comparison Operators
+    bool operator==(mapped_array const &other) const {
+        return n == other.n && std::equal(begin(), end(), other.begin());
+    }
+    bool operator!=(mapped_array const &other) const { return !(*this == other); }
+    bool operator<(mapped_array const &other) const {
+        return std::lexicographical_compare(begin(), end(),
+                                            other.begin(), other.end());
+    }
+    bool operator<=(mapped_array const &other) const { return !(other < *this); }
+    bool operator>(mapped_array const &other) const { return other < *this; }
+    bool operator>=(mapped_array const &other) const { return !(*this < other); }
+};
+
+// Writes [b,e) to path in the format mapped_array reads, replacing
+// anything already there.  Throws std::runtime_error if it can't.
+template < typename InputIterator >
+void write_mapped_array(char const *path, InputIterator b, InputIterator e) {
+    typedef typename std::iterator_traits<InputIterator>::value_type
+        value_type;
+#ifdef ASSIST_HAS_CXX11
+    static_assert(std::is_trivially_copy_constructible<value_type>::value &&
+                  std::is_trivially_destructible<value_type>::value,
+                  "mapped_array elements must be plain data");
+#endif
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    char padding[detail::mapped_array_offset] = {};
+    out.write(padding, sizeof(padding));
+
+    detail::mapped_array_header h;
+    std::memcpy(h.magic, detail::mapped_array_magic, sizeof(h.magic));
+    h.element_size = sizeof(value_type);
+    h.count = 0;
+    h.checksum = detail::fnv1a_basis;
+    for ( ; b != e && out; ++b ) {
+        // hash exactly the bytes written, padding and all
+        value_type const v = *b;
+        char const *const bytes = reinterpret_cast<char const *>(&v);
+        out.write(bytes, sizeof(v));
+        h.checksum = detail::fnv1a(h.checksum, bytes, sizeof(v));
+        ++h.count;
+    }
+
+    out.seekp(0);
+    out.write(reinterpret_cast<char const *>(&h), sizeof(h));
+    out.close();
+    if ( !out ) {
+        throw std::runtime_error(std::string("assist: cannot write ") + path);
+    }
+}
+// Writes out the contents of any of the adapters (or other ranges)
+template < typename adapter_type >
+void write_mapped_array(char const *path, adapter_type const &a) {
+    write_mapped_array(path, a.begin(), a.end());
+}
+
+namespace detail {
+// Contiguous, so integer keys get the vectorised searches too
+template < typename T >
+struct sorted_search< mapped_array<T>, std::less<T> >
+ : simd_search<T> {};
+} // namespace detail
+
+// Overloaded Algorithms
+template < typename T >
+void swap(mapped_array<T> &lhs, mapped_array<T> &rhs) {
+    lhs.swap(rhs);
+}
+
+} // namespace assist
+
+#endif
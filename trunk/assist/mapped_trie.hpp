@@ -0,0 +1,524 @@
+#ifndef ASSIST_MAPPED_TRIE_HPP
+#define ASSIST_MAPPED_TRIE_HPP
+
+/*
+ * assist/mapped_trie.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* A read-only trie in one flat buffer, written out once and memory
+ * mapped back in with nothing to parse or allocate, so a dictionary
+ * built on one machine opens instantly on many others:
+ *
+ *     write_mapped_trie("routes.dat", routes);   // a trie<string, int>
+ *     mapped_trie<std::string, int> r("routes.dat");
+ *     mapped_trie<std::string, int>::const_iterator it
+ *         = r.longest_prefix_match(path);
+ *
+ * It has trie's lookups: find, longest_prefix_match, prefix_range and
+ * count_prefix, in O(key length).  The nodes are laid out in preorder,
+ * each keeping its run of bytes without a branch (as trie does) and
+ * its children's first bytes, in order, with 16 bytes of offsets a
+ * node.  Preorder puts the keys under any node in one run, so the
+ * mapped values are stored in key order, a prefix_range is a slice of
+ * them, and count_prefix doesn't have to visit the matches.
+ *
+ * The keys aren't kept whole: iterators run over the mapped values,
+ * in key order.  Those must be plain data, as for mapped_array.
+ *
+ * The file is a 64 byte header (magic, value size, the counts of
+ * each array and an FNV-1a checksum of the rest) and then the arrays,
+ * in the writer's byte order.  Opening checks the sizes but not the
+ * checksum, which would read the whole file; call verify() for that.
+ * A buffer already in memory, 64-byte aligned, can be used in place.
+ */
+
+#include <cstddef> // size_t, ptrdiff_t
+#include <cstring> // memcmp, memcpy
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator> // iterator_traits
+#include <algorithm> // lower_bound, min, swap
+#include <utility> // pair
+#include <stdexcept> // runtime_error, out_of_range, invalid_argument
+
+#include "detail/config.hpp"
+#include "detail/file_mapping.hpp"
+#include "mapped_array.hpp" // fnv1a
+#include "trie.hpp"
+
+#ifdef ASSIST_HAS_CXX11
+#include <type_traits>
+#endif
+
+namespace assist {
+
+namespace detail {
+
+// Leads every mapped_trie file
+struct mapped_trie_header {
+    char magic[8];
+    unsigned long long value_size;
+    // nodes doesn't count the one past the end
+    unsigned long long nodes;
+    unsigned long long edges;
+    unsigned long long values;
+    unsigned long long bytes;
+    unsigned long long checksum;
+};
+// Last byte is the format version
+char const mapped_trie_magic[8] = { 'a','s','s','i','s','t','T', 1 };
+
+// Each field runs up through the nodes, so the next node's says where
+// this one's stop.  One more node past the end closes the last.
+struct mapped_trie_node {
+    // where its bytes start in the byte array
+    unsigned int prefix;
+    // where its children start in the labels and targets
+    unsigned int edges;
+    // the first value at or under it; it has one of its own if the next
+    // node's is higher
+    unsigned int values;
+    // one past the last node under it
+    unsigned int end;
+};
+
+// Where each array starts
+struct mapped_trie_layout {
+    std::size_t nodes, targets, values, labels, bytes, size;
+    explicit mapped_trie_layout(mapped_trie_header const &h) {
+        nodes = 64;
+        targets = nodes + std::size_t(h.nodes+1) * sizeof(mapped_trie_node);
+        values = targets + std::size_t(h.edges) * sizeof(unsigned int);
+        // keep the values cache line aligned
+        values = ( values + 63 ) / 64 * 64;
+        labels = values + std::size_t(h.values * h.value_size);
+        bytes = labels + std::size_t(h.edges);
+        size = bytes + std::size_t(h.bytes);
+    }
+};
+
+template < typename T >
+struct remove_const { typedef T type; };
+template < typename T >
+struct remove_const<T const> { typedef T type; };
+
+// Lays out keys, which must be in order and distinct
+template < typename Key, typename Traits >
+class mapped_trie_builder {
+    std::vector<Key> const &keys;
+    Traits const &traits;
+
+    void build(std::size_t lo, std::size_t hi, std::size_t depth) {
+        std::size_t const n = nodes.size();
+        mapped_trie_node const node = {
+            static_cast<unsigned int>(bytes.size()),
+            static_cast<unsigned int>(labels.size()),
+            static_cast<unsigned int>(lo), 0 };
+        nodes.push_back(node);
+        // the bytes every key here shares; in order, so the first and
+        // last share the fewest
+        Key const &first = keys[lo];
+        Key const &last = keys[hi-1];
+        std::size_t const stop = std::min(traits.size(first),
+                                          traits.size(last));
+        std::size_t d = depth;
+        while ( d != stop && traits.get(first, d) == traits.get(last, d) ) {
+            bytes.push_back(traits.get(first, d));
+            ++d;
+        }
+        // a key ending here comes first, and is this node's own value
+        if ( traits.size(first) == d ) ++lo;
+        std::size_t const edge = labels.size();
+        for ( std::size_t i = lo; i != hi; ) {
+            unsigned char const b = traits.get(keys[i], d);
+            labels.push_back(b);
+            while ( i != hi && traits.get(keys[i], d) == b ) ++i;
+        }
+        targets.resize(labels.size());
+        for ( std::size_t i = lo, e = edge; i != hi; ++e ) {
+            std::size_t j = i;
+            while ( j != hi && traits.get(keys[j], d) == labels[e] ) ++j;
+            targets[e] = static_cast<unsigned int>(nodes.size());
+            build(i, j, d+1);
+            i = j;
+        }
+        nodes[n].end = static_cast<unsigned int>(nodes.size());
+    }
+
+  public:
+    std::vector<mapped_trie_node> nodes;
+    std::vector<unsigned int> targets;
+    std::vector<unsigned char> labels;
+    std::vector<unsigned char> bytes;
+
+    mapped_trie_builder(std::vector<Key> const &k, Traits const &t)
+     : keys(k), traits(t) {
+        for ( std::size_t i = 1; i < keys.size(); ++i ) {
+            Key const &a = keys[i-1];
+            Key const &b = keys[i];
+            std::size_t const stop = std::min(traits.size(a), traits.size(b));
+            std::size_t d = 0;
+            while ( d != stop && traits.get(a, d) == traits.get(b, d) ) ++d;
+            if ( d == traits.size(b) ||
+                 ( d != traits.size(a) &&
+                   traits.get(a, d) > traits.get(b, d) ) ) {
+                throw std::invalid_argument(
+                    "assist: write_mapped_trie needs distinct keys in order");
+            }
+        }
+        if ( !keys.empty() ) build(0, keys.size(), 0);
+        if ( nodes.size() >= 0xffffffffu || bytes.size() >= 0xffffffffu ) {
+            throw std::runtime_error("assist: too big for a mapped_trie");
+        }
+        mapped_trie_node const past = {
+            static_cast<unsigned int>(bytes.size()),
+            static_cast<unsigned int>(labels.size()),
+            static_cast<unsigned int>(keys.size()),
+            static_cast<unsigned int>(nodes.size()) };
+        nodes.push_back(past);
+    }
+};
+
+// Writes n bytes from p, adding them to the checksum h
+inline void put_mapped_bytes(std::ostream &out, unsigned long long &h,
+                             void const *p, std::size_t n) {
+    out.write(static_cast<char const *>(p), n);
+    h = fnv1a(h, p, n);
+}
+
+} // namespace detail
+
+template < typename Key, typename T, typename Traits = trie_traits<Key> >
+class mapped_trie {
+#ifdef ASSIST_HAS_CXX11
+    static_assert(std::is_trivially_copy_constructible<T>::value &&
+                  std::is_trivially_destructible<T>::value,
+                  "mapped_trie values must be plain data");
+#endif
+  public:
+    // Types
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef Traits traits_type;
+    typedef T const &reference;
+    typedef T const &const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef T const *iterator;
+    typedef T const *const_iterator;
+
+  private:
+    typedef detail::mapped_trie_node node;
+
+    detail::file_mapping file;
+    char const *start;
+    std::size_t length;
+    node const *nodes;
+    unsigned int const *targets;
+    T const *values;
+    unsigned char const *labels;
+    unsigned char const *bytes;
+    std::size_t n;
+    Traits traits;
+
+    static void fail(char const *what) {
+        throw std::runtime_error(std::string("assist: ") + what +
+                                 " is not a mapped_trie of this type");
+    }
+    detail::mapped_trie_header const &header() const {
+        return *reinterpret_cast<detail::mapped_trie_header const *>(start);
+    }
+    void open(char const *what) {
+        if ( length < 64 ||
+             std::memcmp(header().magic, detail::mapped_trie_magic,
+                         sizeof(detail::mapped_trie_magic)) != 0 ||
+             header().value_size != sizeof(T) ||
+             // the byte array's offsets are 32 bits, so bounds the rest
+             header().bytes >= 0xffffffffULL ||
+             header().nodes >= 0xffffffffULL ||
+             header().edges > 256 * header().nodes ||
+             header().values > header().nodes ||
+             detail::mapped_trie_layout(header()).size != length ) {
+            fail(what);
+        }
+        detail::mapped_trie_layout const at(header());
+        nodes = reinterpret_cast<node const *>(start + at.nodes);
+        targets = reinterpret_cast<unsigned int const *>(start + at.targets);
+        values = reinterpret_cast<T const *>(start + at.values);
+        labels = reinterpret_cast<unsigned char const *>(start + at.labels);
+        bytes = reinterpret_cast<unsigned char const *>(start + at.bytes);
+        n = std::size_t(header().values);
+    }
+
+    bool has_value(unsigned i) const {
+        return nodes[i+1].values != nodes[i].values;
+    }
+    // The child of node i on byte b, or 0 (which is never a child)
+    unsigned child(unsigned i, unsigned char b) const {
+        unsigned char const *const first = labels + nodes[i].edges;
+        unsigned char const *const last = labels + nodes[i+1].edges;
+        unsigned char const *e = first;
+        if ( last - first <= 8 ) {
+            while ( e != last && *e < b ) ++e;
+        } else {
+            e = std::lower_bound(first, last, b);
+        }
+        return e != last && *e == b ? targets[e - labels] : 0;
+    }
+    // How many of node i's bytes k matches from depth on
+    std::size_t match(unsigned i, key_type const &k,
+                      std::size_t depth) const {
+        unsigned char const *const p = bytes + nodes[i].prefix;
+        std::size_t const stop = std::min<std::size_t>(
+                                     nodes[i+1].prefix - nodes[i].prefix,
+                                     traits.size(k) - depth);
+        std::size_t m = 0;
+        while ( m != stop && p[m] == traits.get(k, depth+m) ) ++m;
+        return m;
+    }
+    std::size_t prefix_length(unsigned i) const {
+        return nodes[i+1].prefix - nodes[i].prefix;
+    }
+
+    // The node whose keys are those starting with prefix (or, if whole,
+    // just prefix), or the number of nodes
+    unsigned find_node(key_type const &prefix, bool whole) const {
+        unsigned const none = unsigned(header().nodes);
+        if ( !none ) return none;
+        std::size_t const size = traits.size(prefix);
+        unsigned i = 0;
+        std::size_t depth = 0;
+        for ( ;; ) {
+            std::size_t const m = match(i, prefix, depth);
+            if ( m != prefix_length(i) ) {
+                // prefix ran out partway through the node's bytes
+                return !whole && depth + m == size ? i : none;
+            }
+            depth += m;
+            if ( depth == size ) return i;
+            i = child(i, traits.get(prefix, depth++));
+            if ( !i ) return none;
+        }
+    }
+
+  public:
+    // Construct/Copy/Destroy
+    mapped_trie()
+     : start(0), length(0), nodes(0), targets(0), values(0), labels(0),
+       bytes(0), n(0) {}
+    // Throws std::runtime_error if path can't be mapped, or doesn't
+    // hold a trie of T written by write_mapped_trie.
+    explicit mapped_trie(char const *path,
+                         traits_type const &t = traits_type())
+     : file(path), start(file.data()), length(file.size()), n(0),
+       traits(t) {
+        open(path);
+    }
+    explicit mapped_trie(std::string const &path,
+                         traits_type const &t = traits_type())
+     : file(path.c_str()), start(file.data()), length(file.size()), n(0),
+       traits(t) {
+        open(path.c_str());
+    }
+    // Uses the size bytes at data, which must outlive this and its copies
+    mapped_trie(void const *data, std::size_t size,
+                traits_type const &t = traits_type())
+     : start(static_cast<char const *>(data)), length(size), n(0),
+       traits(t) {
+        open("buffer");
+    }
+    // default copy ctr
+    // default destructor
+    // default assignment
+
+    // Iterators
+    const_iterator begin() const { return values; }
+    const_iterator end() const { return values+n; }
+
+    // Capacity
+    bool empty() const { return n == 0; }
+    size_type size() const { return n; }
+
+    // Element Access
+    mapped_type const &at(key_type const &k) const {
+        const_iterator const it = find(k);
+        if ( it == end() ) throw std::out_of_range("assist: mapped_trie::at");
+        return *it;
+    }
+
+    // Map operations
+    size_type count(key_type const &k) const {
+        return contains(k) ? 1 : 0;
+    }
+    const_iterator find(key_type const &k) const {
+        if ( !n ) return end();
+        unsigned const i = find_node(k, true);
+        if ( i == header().nodes || !has_value(i) ) return end();
+        return values + nodes[i].values;
+    }
+    bool contains(key_type const &k) const {
+        return find(k) != end();
+    }
+
+    // Prefix operations
+    // The value of the longest key that's a prefix of k, or end()
+    const_iterator longest_prefix_match(key_type const &k) const {
+        if ( !n ) return end();
+        std::size_t const size = traits.size(k);
+        const_iterator best = end();
+        unsigned i = 0;
+        std::size_t depth = 0;
+        for ( ;; ) {
+            std::size_t const m = match(i, k, depth);
+            if ( m != prefix_length(i) ) break;
+            depth += m;
+            if ( has_value(i) ) best = values + nodes[i].values;
+            if ( depth == size ) break;
+            i = child(i, traits.get(k, depth++));
+            if ( !i ) break;
+        }
+        return best;
+    }
+    // The values of the keys that start with prefix, in key order
+    std::pair<const_iterator, const_iterator>
+    prefix_range(key_type const &prefix) const {
+        if ( !n ) return std::make_pair(end(), end());
+        unsigned const i = find_node(prefix, false);
+        if ( i == header().nodes ) return std::make_pair(end(), end());
+        return std::make_pair(values + nodes[i].values,
+                              values + nodes[nodes[i].end].values);
+    }
+    // How many keys start with prefix; O(its length)
+    size_type count_prefix(key_type const &prefix) const {
+        std::pair<const_iterator, const_iterator> const r
+            = prefix_range(prefix);
+        return r.second - r.first;
+    }
+
+    // Extra
+    // Recomputes the checksum, reading the whole buffer to do so
+    bool verify() const {
+        if ( !start ) return true;
+        return detail::fnv1a(detail::fnv1a_basis, start + 64, length - 64)
+               == header().checksum;
+    }
+
+    void swap(mapped_trie &other) {
+        file.swap(other.file);
+        std::swap( start, other.start );
+        std::swap( length, other.length );
+        std::swap( nodes, other.nodes );
+        std::swap( targets, other.targets );
+        std::swap( values, other.values );
+        std::swap( labels, other.labels );
+        std::swap( bytes, other.bytes );
+        std::swap( n, other.n );
+        std::swap( traits, other.traits );
+    }
+};
+
+// Writes the pairs in [b,e), which must have distinct keys in order,
+// to out in the format mapped_trie reads, starting where out is.  out
+// must be seekable, to go back for the header.  Throws
+// std::invalid_argument if they aren't in order, and
+// std::runtime_error if out fails.
+template < typename InputIterator, typename Traits >
+void write_mapped_trie(std::ostream &out, InputIterator b, InputIterator e,
+                       Traits const &traits) {
+    typedef typename std::iterator_traits<InputIterator>::value_type pair;
+    typedef typename detail::remove_const<
+                typename pair::first_type>::type key_type;
+    typedef typename pair::second_type value_type;
+#ifdef ASSIST_HAS_CXX11
+    static_assert(std::is_trivially_copy_constructible<value_type>::value &&
+                  std::is_trivially_destructible<value_type>::value,
+                  "mapped_trie values must be plain data");
+#endif
+    std::vector<key_type> keys;
+    std::vector<value_type> values;
+    for ( ; b != e; ++b ) {
+        keys.push_back(b->first);
+        values.push_back(b->second);
+    }
+    detail::mapped_trie_builder<key_type, Traits> const t(keys, traits);
+
+    detail::mapped_trie_header h;
+    std::memcpy(h.magic, detail::mapped_trie_magic, sizeof(h.magic));
+    h.value_size = sizeof(value_type);
+    h.nodes = t.nodes.size() - 1;
+    h.edges = t.labels.size();
+    h.values = values.size();
+    h.bytes = t.bytes.size();
+    h.checksum = detail::fnv1a_basis;
+    detail::mapped_trie_layout const at(h);
+    char const padding[64] = {};
+    std::streampos const start = out.tellp();
+    if ( start == std::streampos(-1) ) {
+        throw std::runtime_error("assist: mapped_trie needs a seekable stream");
+    }
+    out.write(padding, sizeof(padding));
+    detail::put_mapped_bytes(out, h.checksum, &t.nodes[0],
+                             t.nodes.size() * sizeof(t.nodes[0]));
+    if ( !t.targets.empty() ) {
+        detail::put_mapped_bytes(out, h.checksum, &t.targets[0],
+                                 t.targets.size() * sizeof(t.targets[0]));
+    }
+    detail::put_mapped_bytes(out, h.checksum, padding,
+                             at.values - at.targets
+                             - t.targets.size() * sizeof(t.targets[0]));
+    if ( !values.empty() ) {
+        detail::put_mapped_bytes(out, h.checksum, &values[0],
+                                 values.size() * sizeof(value_type));
+    }
+    if ( !t.labels.empty() ) {
+        detail::put_mapped_bytes(out, h.checksum, &t.labels[0],
+                                 t.labels.size());
+    }
+    if ( !t.bytes.empty() ) {
+        detail::put_mapped_bytes(out, h.checksum, &t.bytes[0],
+                                 t.bytes.size());
+    }
+    out.seekp(start);
+    out.write(reinterpret_cast<char const *>(&h), sizeof(h));
+    out.seekp(0, std::ios::end);
+    if ( !out ) {
+        throw std::runtime_error("assist: cannot write mapped_trie");
+    }
+}
+// The same, to the file at path, replacing anything already there.
+// Throws std::runtime_error if it can't.
+template < typename InputIterator, typename Traits >
+void write_mapped_trie(char const *path, InputIterator b, InputIterator e,
+                       Traits const &traits) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    write_mapped_trie(out, b, e, traits);
+    out.close();
+    if ( !out ) {
+        throw std::runtime_error(std::string("assist: cannot write ") + path);
+    }
+}
+template < typename Key, typename T, typename Traits >
+void write_mapped_trie(char const *path, trie<Key, T, Traits> const &t) {
+    write_mapped_trie(path, t.begin(), t.end(), t.traits());
+}
+template < typename Key, typename T, typename Traits >
+void write_mapped_trie(std::ostream &out, trie<Key, T, Traits> const &t) {
+    write_mapped_trie(out, t.begin(), t.end(), t.traits());
+}
+
+// Overloaded Algorithms
+template < typename Key, typename T, typename Traits >
+void swap(mapped_trie<Key, T, Traits> &lhs, mapped_trie<Key, T, Traits> &rhs) {
+    lhs.swap(rhs);
+}
+
+} // namespace assist
+
+#endif
@@ -17,13 +17,14 @@ namespace assist {
 
 template < typename base_type,
             typename CMP = std::less<typename base_type::value_type
-                                                         ::first_type> >
+                                                         ::first_type>,
+            typename Stats = no_stats >
 class multimap_adapter {
   public:
     // Types
     typedef typename base_type::value_type value_type;
     typedef typename value_type::first_type key_type;
-    typedef typename value_type::second_type multimapped_type;
+    typedef typename value_type::second_type mapped_type;
     typedef CMP key_compare;
     struct value_compare {
         key_compare key_comparator;
@@ -40,13 +41,37 @@ class multimap_adapter {
                          key_type const &rhs) const {
             return key_comparator(lhs.first, rhs);
         }
+        // for sorting batches of keys
+        bool operator()(key_type const &lhs,
+                         key_type const &rhs) const {
+            return key_comparator(lhs, rhs);
+        }
+#ifdef ASSIST_HAS_CXX11
+        template <typename K>
+        bool operator()(K const &lhs, value_type const &rhs) const {
+            return key_comparator(lhs, rhs.first);
+        }
+        template <typename K>
+        bool operator()(value_type const &lhs, K const &rhs) const {
+            return key_comparator(lhs.first, rhs);
+        }
+#endif
     };
 
   private:
-    typedef multiset_adapter< base_type, value_compare > multiset_type; 
+    typedef multiset_adapter< base_type, value_compare, Stats > multiset_type; 
 //    typedef std::multiset< value_type, value_compare, typename base_type::allocator_type > multiset_type; 
     multiset_type c;
     // c holds the comparator
+    // value_comp(), counting calls if Stats does
+    typedef detail::stats_compare<value_compare, Stats> compare_source;
+    typedef typename compare_source::type compare_type;
+
+    // c's counters are mutable
+    Stats &counters() const { return const_cast<Stats &>(c.stats()); }
+    compare_type compare() const {
+        return compare_source::get(value_comp(), counters());
+    }
 
   public:
     // Types
@@ -72,6 +97,16 @@ class multimap_adapter {
                 const key_compare &cmp = key_compare(), 
                 const allocator_type &alloc = allocator_type ())
      : c(b, e, cmp, alloc) {}
+    template <class InputIterator>
+    multimap_adapter(parallel_t p, InputIterator b, InputIterator e, 
+                const key_compare &cmp = key_compare(), 
+                const allocator_type &alloc = allocator_type ())
+     : c(p, b, e, cmp, alloc) {}
+    template <class InputIterator>
+    multimap_adapter(sorted_equivalent_t t, InputIterator b, InputIterator e, 
+                const key_compare &cmp = key_compare(), 
+                const allocator_type &alloc = allocator_type ())
+     : c(t, b, e, cmp, alloc) {}
     // default copy ctr
     // default destructor
     // default assignment
@@ -83,6 +118,21 @@ class multimap_adapter {
         c = b;
         return *this;
     }
+    multimap_adapter(sorted_equivalent_t t, base_type const &b,
+                          const key_compare &cmp = key_compare())
+     : c(t,b,cmp) {}
+#ifdef ASSIST_HAS_CXX11
+    explicit multimap_adapter(base_type &&b,
+                          const key_compare &cmp = key_compare())
+     : c(std::move(b),cmp) {}
+    multimap_adapter &operator=(base_type &&b) {
+        c = std::move(b);
+        return *this;
+    }
+    multimap_adapter(sorted_equivalent_t t, base_type &&b,
+                          const key_compare &cmp = key_compare())
+     : c(t,std::move(b),cmp) {}
+#endif
 
     multiset_type const &multiset() const { return c; }
     base_type const &base() const { return c.base(); }
@@ -104,6 +154,8 @@ class multimap_adapter {
     // Extra
     size_type capacity() const { return c.capacity(); }
     void reserve(size_type n) { return c.reserve(n); }
+    // Gives back the capacity left over after erasing
+    void shrink_to_fit() { c.shrink_to_fit(); }
 
     // Modifiers
     iterator insert(const value_type &v) {
@@ -112,13 +164,55 @@ class multimap_adapter {
     iterator insert(iterator hint, const value_type &v) {
         return c.insert(hint, v);
     }
+#ifdef ASSIST_HAS_CXX11
+    iterator insert(value_type &&v) {
+        return c.insert(std::move(v));
+    }
+    iterator insert(iterator hint, value_type &&v) {
+        return c.insert(hint, std::move(v));
+    }
+    template <class... Args>
+    iterator emplace(Args &&...args) {
+        return c.emplace(std::forward<Args>(args)...);
+    }
+    template <class... Args>
+    iterator emplace_hint(iterator hint, Args &&...args) {
+        return c.emplace_hint(hint, std::forward<Args>(args)...);
+    }
+#endif
     template <class InputIterator>
     void insert(InputIterator b, InputIterator const e) {
         return c.insert(b,e);
     }
+    template <class InputIterator>
+    void insert(parallel_t p, InputIterator b, InputIterator const e) {
+        return c.insert(p,b,e);
+    }
     void erase(iterator it) { c.erase(it); }
-    size_type erase(const key_type &k) { c.erase(k); }
+    size_type erase(const key_type &k) {
+        std::pair<iterator, iterator> r = equal_range(k);
+        size_type const n = r.second - r.first;
+        c.erase(r.first, r.second);
+        return n;
+    }
     void erase(iterator b, iterator e) { c.erase(b, e); }
+    // Bulk removal, compacting in one pass; each returns how many
+    // elements were removed.
+    template <class Predicate>
+    size_type erase_if(Predicate pred) { return c.erase_if(pred); }
+    template <class Predicate>
+    size_type retain_if(Predicate pred) { return c.retain_if(pred); }
+    // Removes every element with one of the keys [b,e).
+    // Keys in order are swept in one pass; others are sorted first.
+    template <class ForwardIterator>
+    size_type erase_keys(ForwardIterator b, ForwardIterator e) {
+        return c.erase_keys(b, e);
+    }
+    // ...or every element that doesn't have one
+    template <class ForwardIterator>
+    size_type retain_keys(ForwardIterator b, ForwardIterator e) {
+        return c.retain_keys(b, e);
+    }
     void swap(multimap_adapter &other) {
         using namespace std;
         c.swap(other.c); // swap( c, other.c );
@@ -130,53 +224,141 @@ class multimap_adapter {
         using namespace std;
         c.swap(other); // swap( c, other.c );
     }
+    void swap(parallel_t p, base_type &other) {
+        c.swap(p, other);
+    }
+    void swap(sorted_equivalent_t t, base_type &other) {
+        c.swap(t, other);
+    }
+#ifdef ASSIST_HAS_CXX11
+    void adopt(sorted_equivalent_t t, base_type &&b) {
+        c.adopt(t, std::move(b));
+    }
+#endif
 
     // Observers
     value_compare value_comp() const { return c.value_comp(); }
     key_compare key_comp() const { return value_comp().key_comparator; }
+    // Extra
+    Stats const &stats() const { return c.stats(); }
+    Stats &stats() { return c.stats(); }
 
     // Map operations
     size_type count(const key_type &k) const {
-        std::pair<iterator, iterator> er = equal_range(k);
+        std::pair<const_iterator, const_iterator> er = equal_range(k);
         return er.second-er.first;
     }
     std::pair<iterator, iterator> equal_range(const key_type &k) {
-        return std::equal_range(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return std::equal_range(begin(), end(), k, compare());
     }
     std::pair<const_iterator, const_iterator> equal_range(const key_type &k) const {
-        return std::equal_range(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return std::equal_range(begin(), end(), k, compare());
     }
     iterator find(const key_type &k) {
-        iterator it = lower_bound(k);
-        if ( it == end() || comparator(k, *it) ) {
+        detail::lookup_probe<Stats> probe(counters());
+        iterator it = std::lower_bound(begin(), end(), k, compare());
+        if ( it == end() || compare()(k, *it) ) {
             return end();
         } else {
             return it;
         }
     }
     const_iterator find(const key_type &k) const {
-        const_iterator it = lower_bound(k);
-        if ( it == end() || comparator(k, *it) ) {
+        detail::lookup_probe<Stats> probe(counters());
+        const_iterator it = std::lower_bound(begin(), end(), k, compare());
+        if ( it == end() || compare()(k, *it) ) {
             return end();
         } else {
             return it;
         }
     }
     iterator lower_bound(const key_type &k) {
-        return std::lower_bound(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return std::lower_bound(begin(), end(), k, compare());
     }
     const_iterator lower_bound(const key_type &k) const {
-        return std::lower_bound(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return std::lower_bound(begin(), end(), k, compare());
     }
     iterator upper_bound(const key_type &k) {
-        return std::upper_bound(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return std::upper_bound(begin(), end(), k, compare());
     }
     const_iterator upper_bound(const key_type &k) const {
-        return std::upper_bound(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return std::upper_bound(begin(), end(), k, compare());
     }
     bool contains(const key_type &k) const {
-        return std::binary_search(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return std::binary_search(begin(), end(), k, compare());
     }
+#ifdef ASSIST_HAS_CXX11
+    // Heterogeneous lookup, for comparators declaring is_transparent
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    size_type count(const K &k) const {
+        std::pair<const_iterator, const_iterator> er = equal_range(k);
+        return er.second-er.first;
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K &k) {
+        detail::lookup_probe<Stats> probe(counters());
+        return std::equal_range(begin(), end(), k, compare());
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    std::pair<const_iterator, const_iterator> equal_range(const K &k) const {
+        detail::lookup_probe<Stats> probe(counters());
+        return std::equal_range(begin(), end(), k, compare());
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    iterator find(const K &k) {
+        detail::lookup_probe<Stats> probe(counters());
+        iterator it = std::lower_bound(begin(), end(), k, compare());
+        return ( it == end() || compare()(k, *it) ) ? end() : it;
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    const_iterator find(const K &k) const {
+        detail::lookup_probe<Stats> probe(counters());
+        const_iterator it = std::lower_bound(begin(), end(), k, compare());
+        return ( it == end() || compare()(k, *it) ) ? end() : it;
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    iterator lower_bound(const K &k) {
+        detail::lookup_probe<Stats> probe(counters());
+        return std::lower_bound(begin(), end(), k, compare());
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    const_iterator lower_bound(const K &k) const {
+        detail::lookup_probe<Stats> probe(counters());
+        return std::lower_bound(begin(), end(), k, compare());
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    iterator upper_bound(const K &k) {
+        detail::lookup_probe<Stats> probe(counters());
+        return std::upper_bound(begin(), end(), k, compare());
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    const_iterator upper_bound(const K &k) const {
+        detail::lookup_probe<Stats> probe(counters());
+        return std::upper_bound(begin(), end(), k, compare());
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    bool contains(const K &k) const {
+        detail::lookup_probe<Stats> probe(counters());
+        return std::binary_search(begin(), end(), k, compare());
+    }
+#endif
   
     // Comparison Operators
     bool operator==(multimap_adapter const &other) { return c == other.c; }
@@ -189,20 +371,20 @@ class multimap_adapter {
 
 // Overloaded Algorithms
 template < typename base_type,
-            typename CMP >
-void swap(multimap_adapter<base_type,CMP> const &lhs,
-          multimap_adapter<base_type,CMP> const &rhs) {
+            typename CMP, typename Stats >
+void swap(multimap_adapter<base_type,CMP,Stats> const &lhs,
+          multimap_adapter<base_type,CMP,Stats> const &rhs) {
     lhs.swap(rhs);
 }
 template < typename base_type,
-            typename CMP >
+            typename CMP, typename Stats >
 void swap(base_type const &lhs,
-          multimap_adapter<base_type,CMP> const &rhs) {
+          multimap_adapter<base_type,CMP,Stats> const &rhs) {
     lhs.swap(rhs);
 }
 template < typename base_type,
-            typename CMP >
-void swap(multimap_adapter<base_type,CMP> const &lhs,
+            typename CMP, typename Stats >
+void swap(multimap_adapter<base_type,CMP,Stats> const &lhs,
           base_type const &rhs) {
     lhs.swap(rhs);
 }
@@ -214,20 +396,20 @@ namespace std {
 
 // Overloaded Algorithms
 template < typename base_type,
-            typename CMP >
-void swap(assist::multimap_adapter<base_type,CMP> const &lhs,
-          assist::multimap_adapter<base_type,CMP> const &rhs) {
+            typename CMP, typename Stats >
+void swap(assist::multimap_adapter<base_type,CMP,Stats> const &lhs,
+          assist::multimap_adapter<base_type,CMP,Stats> const &rhs) {
     assist::swap(lhs,rhs);
 }
 template < typename base_type,
-            typename CMP >
+            typename CMP, typename Stats >
 void swap(base_type const &lhs,
-          assist::multimap_adapter<base_type,CMP> const &rhs) {
+          assist::multimap_adapter<base_type,CMP,Stats> const &rhs) {
     assist::swap(lhs,rhs);
 }
 template < typename base_type,
-            typename CMP >
-void swap(assist::multimap_adapter<base_type,CMP> const &lhs,
+            typename CMP, typename Stats >
+void swap(assist::multimap_adapter<base_type,CMP,Stats> const &lhs,
           base_type const &rhs) {
     assist::swap(lhs,rhs);
 }
@@ -17,16 +17,48 @@
 
 #include <utility> // pair
 #include <algorithm> // sort, swap, inplace_merge,
-                     // equal_range, lower_bound, upper_bound
+                     // equal_range, lower_bound, upper_bound,
+                     // remove_if, find_if
 #include <functional> // less,
+#include <cassert>
+
+#include "detail/config.hpp"
+#include "detail/compare.hpp"
+#include "detail/sorted_search.hpp"
+#include "detail/batch_search.hpp"
+#include "detail/parallel_sort.hpp"
+#include "tags.hpp"
+#include "detail/compact.hpp"
+#include "detail/stats.hpp"
 
 namespace assist {
 
 template < typename base_type,
-            typename CMP = std::less<typename base_type::value_type> >
-class multiset_adapter {
+            typename CMP = std::less<typename base_type::value_type>,
+            typename Stats = no_stats >
+class multiset_adapter : detail::stats_holder<Stats> {
     base_type c;
     CMP comparator;
+    // comparator, counting calls if Stats does
+    typedef detail::stats_compare<CMP, Stats> compare_source;
+    typedef typename compare_source::type compare_type;
+    // std algorithms, or vectorised kernels for integer keys
+    typedef detail::sorted_search<base_type, compare_type> search;
+    using detail::stats_holder<Stats>::counters;
+
+    compare_type compare() const {
+        return compare_source::get(comparator, counters());
+    }
+    // Whether c is sorted
+    bool ordered() const {
+        return std::adjacent_find(c.begin(), c.end(),
+                   detail::reversed_compare<compare_type>(compare())) == c.end();
+    }
+    // Restores the ordering after c was filled from outside.
+    // Input that is already sorted only pays for the check.
+    void normalize(unsigned threads = 1) {
+        if ( !ordered() ) sort(c.begin(), c.end(), threads);
+    }
 
   public:
     // Types
@@ -47,6 +79,67 @@ class multiset_adapter {
     typedef typename base_type::const_reverse_iterator const_reverse_iterator;
 //    typedef typename base_type:: ;
 
+  private:
+    // Where v belongs, after any equivalents
+    iterator locate(const value_type &v) {
+        detail::lookup_probe<Stats> probe(counters());
+        compare_type const cmp = compare();
+        iterator const begin = c.begin(), end = c.end();
+        if ( begin == end || !cmp(v, *(end-1)) ) {
+            // appending, so amortised O(1)
+            return end;
+        }
+        if ( end-begin > detail::tail_window &&
+             !cmp(v, *(end-detail::tail_window)) ) {
+            return std::upper_bound(end-detail::tail_window+1, end-1,
+                                    v, cmp);
+        }
+        return search::upper_bound(begin, end, v, cmp);
+    }
+    // hint if v can go right before it, otherwise as close to it as
+    // it can go, searching out from hint
+    iterator locate(iterator hint, const value_type &v) {
+        detail::lookup_probe<Stats> probe(counters());
+        compare_type const cmp = compare();
+        if ( hint != c.begin() && cmp(v, *(hint-1)) ) {
+            return detail::finger_upper_bound(c.begin(), c.end(),
+                                              hint, v, cmp);
+        }
+        if ( hint != c.end() && cmp(*hint, v) ) {
+            return detail::finger_lower_bound(c.begin(), c.end(),
+                                              hint, v, cmp);
+        }
+        return hint;
+    }
+    // Inserts v at it, counting the elements moved along to make room
+#ifdef ASSIST_HAS_CXX11
+    template < typename V >
+    iterator insert_at(iterator it, V &&v) {
+        detail::growth_probe<Stats, base_type> growth(counters(), c);
+        counters().on_move(end()-it);
+        return c.insert(it, std::forward<V>(v));
+    }
+#else
+    iterator insert_at(iterator it, const value_type &v) {
+        detail::growth_probe<Stats, base_type> growth(counters(), c);
+        counters().on_move(end()-it);
+        return c.insert(it, v);
+    }
+#endif
+    // Sorting and merging count their comparisons on one thread only
+    void sort(iterator b, iterator e, unsigned threads) {
+        counters().on_sort();
+        if ( threads == 1 ) std::sort(b, e, compare());
+        else detail::parallel_sort(b, e, comparator, threads);
+    }
+    void merge(iterator b, iterator m, iterator e, unsigned threads) {
+        counters().on_merge();
+        counters().on_move(e-b);
+        if ( threads == 1 ) std::inplace_merge(b, m, e, compare());
+        else detail::parallel_inplace_merge(b, m, e, comparator, threads);
+    }
+
+  public:
     // Construct/Copy/Destroy
     explicit multiset_adapter(const key_compare &cmp = key_compare(), 
                           const allocator_type &alloc = allocator_type ())
@@ -56,7 +149,21 @@ class multiset_adapter {
                 const key_compare &cmp = key_compare(), 
                 const allocator_type &alloc = allocator_type ())
      : c(b, e, alloc), comparator(cmp) {
-        std::sort(begin(), end(), comparator);
+        normalize();
+    }
+    template <class InputIterator>
+    multiset_adapter(parallel_t p, InputIterator b, InputIterator e,
+                const key_compare &cmp = key_compare(), 
+                const allocator_type &alloc = allocator_type ())
+     : c(b, e, alloc), comparator(cmp) {
+        normalize(p.threads);
+    }
+    template <class InputIterator>
+    multiset_adapter(sorted_equivalent_t, InputIterator b, InputIterator e,
+                const key_compare &cmp = key_compare(), 
+                const allocator_type &alloc = allocator_type ())
+     : c(b, e, alloc), comparator(cmp) {
+        assert( ordered() );
     }
     // default copy ctr
     // default destructor
@@ -65,13 +172,35 @@ class multiset_adapter {
     explicit multiset_adapter(base_type const &b,
                           const key_compare &cmp = key_compare())
      : c(b), comparator(cmp) {
-        std::sort(begin(), end(), comparator);
+        normalize();
     }
     multiset_adapter &operator=(base_type const &b) {
         c = b;
-        std::sort(begin(), end(), comparator);
+        normalize();
+        return *this;
+    }
+    multiset_adapter(sorted_equivalent_t, base_type const &b,
+                          const key_compare &cmp = key_compare())
+     : c(b), comparator(cmp) {
+        assert( ordered() );
+    }
+#ifdef ASSIST_HAS_CXX11
+    explicit multiset_adapter(base_type &&b,
+                          const key_compare &cmp = key_compare())
+     : c(std::move(b)), comparator(cmp) {
+        normalize();
+    }
+    multiset_adapter &operator=(base_type &&b) {
+        c = std::move(b);
+        normalize();
         return *this;
     }
+    multiset_adapter(sorted_equivalent_t, base_type &&b,
+                          const key_compare &cmp = key_compare())
+     : c(std::move(b)), comparator(cmp) {
+        assert( ordered() );
+    }
+#endif
 
     base_type const &base() const { return c; }
 
@@ -92,40 +221,46 @@ class multiset_adapter {
     // Extra
     size_type capacity() const { return c.capacity(); }
     void reserve(size_type n) { return c.reserve(n); }
+    // Gives back the capacity left over after erasing
+    void shrink_to_fit() {
+#ifdef ASSIST_HAS_CXX11
+        c.shrink_to_fit();
+#else
+        base_type(c).swap(c);
+#endif
+    }
 
     // Modifiers
     iterator insert(const value_type &v) {
-        iterator it = lower_bound(v);
-        return c.insert(it, v);
+        return insert_at(locate(v), v);
     }
-/*
     iterator insert(iterator hint, const value_type &v) {
-    ******FIX******
-        if ( hint >= end()-1 ) {
-            if ( empty() || !comparator(v,*(end()-1)) ) {
-                c.push_back(v);
-                return end();
-            } else {
-                return insert(v).first;
-            }
-        }
-        if ( !comparator( v, *hint ) ) {
-            if ( comparator( v, *(hint+1) ) ) {
-                // right place
-                return c.insert(hint, v);       
-            } else {
-                // *hint equivalent to v
-                // nothing to do
-                return hint;
-            }
-        } else {
-            // hint was wrong
-            return insert(v).first;
-        }
+        return insert_at(locate(hint, v), v);
     }
-*/
+#ifdef ASSIST_HAS_CXX11
+    iterator insert(value_type &&v) {
+        iterator const it = locate(v);
+        return insert_at(it, std::move(v));
+    }
+    iterator insert(iterator hint, value_type &&v) {
+        iterator const it = locate(hint, v);
+        return insert_at(it, std::move(v));
+    }
+    template <class... Args>
+    iterator emplace(Args &&...args) {
+        return insert(value_type(std::forward<Args>(args)...));
+    }
+    template <class... Args>
+    iterator emplace_hint(iterator hint, Args &&...args) {
+        return insert(hint, value_type(std::forward<Args>(args)...));
+    }
+#endif
     template <class InputIterator>
     void insert(InputIterator b, InputIterator const e) {
+        insert(parallel_t(1), b, e);
+    }
+    template <class InputIterator>
+    void insert(parallel_t p, InputIterator b, InputIterator const e) {
     /*
         // Simple, obvious, but often slow
         // basic exception safe.
@@ -135,18 +270,69 @@ class multiset_adapter {
         // *Not* safe if the comparator throws, though :|
         size_type const before_size = size();
         try {
+            detail::growth_probe<Stats, base_type> growth(counters(), c);
             c.insert(c.end(), b, e);
         } catch (...) {
             assert( size() >= before_size );
             if ( size() != before_size ) c.resize(before_size);
             throw;
         }
-        std::sort(begin()+before_size, end(), comparator);
-        std::inplace_merge(begin(), begin()+before_size, end(), comparator);
+        sort(begin()+before_size, end(), p.threads);
+        merge(begin(), begin()+before_size, end(), p.threads);
+    }
+    void erase(iterator it) {
+        counters().on_move(end()-it-1);
+        c.erase(it);
+    }
+    size_type erase(const key_type &k) {
+        std::pair<iterator, iterator> r = equal_range(k);
+        size_type const n = r.second - r.first;
+        erase(r.first, r.second);
+        return n;
+    }
+    void erase(iterator b, iterator e) {
+        counters().on_move(end()-e);
+        c.erase(b, e);
+    }
+    // Bulk removal, compacting c in one pass; each returns how many
+    // elements were removed.
+    template <class Predicate>
+    size_type erase_if(Predicate pred) {
+        size_type const before_size = size();
+        // only the survivors after the first removal are shifted
+        iterator const first = std::find_if(begin(), end(), pred);
+        iterator const last = std::remove_if(first, end(), pred);
+        counters().on_move(last-first);
+        c.erase(last, end());
+        return before_size - size();
+    }
+    template <class Predicate>
+    size_type retain_if(Predicate pred) {
+        return erase_if(detail::negated_predicate<Predicate>(pred));
+    }
+    // Removes every element equivalent to one of the keys [b,e).
+    // Keys in order are swept in one pass; others are sorted first.
+    template <class ForwardIterator>
+    size_type erase_keys(ForwardIterator b, ForwardIterator e) {
+        size_type const before_size = size();
+        std::size_t moved = 0;
+        c.erase(detail::remove_keys(begin(), end(), b, e, compare(), false,
+                                    moved),
+                end());
+        counters().on_move(moved);
+        return before_size - size();
+    }
+    // ...or every element that isn't
+    template <class ForwardIterator>
+    size_type retain_keys(ForwardIterator b, ForwardIterator e) {
+        size_type const before_size = size();
+        std::size_t moved = 0;
+        c.erase(detail::remove_keys(begin(), end(), b, e, compare(), true,
+                                    moved),
+                end());
+        counters().on_move(moved);
+        return before_size - size();
     }
-    void erase(iterator it) { c.erase(it); }
-    size_type erase(const key_type &k) { c.erase(find(k)); }
-    void erase(iterator b, iterator e) { c.erase(b, e); }
     void swap(multiset_adapter &other) {
         using namespace std;
         // swap comparator first for exception safety
@@ -160,11 +346,32 @@ class multiset_adapter {
     void swap(base_type &other) {
         using namespace std;
         c.swap(other); // swap( c, other.c );
-        std::sort(begin(), end(), comparator);
+        normalize();
+    }
+    void swap(parallel_t p, base_type &other) {
+        c.swap(other);
+        normalize(p.threads);
+    }
+    // O(1): other must already be in order
+    void swap(sorted_equivalent_t, base_type &other) {
+        c.swap(other);
+        assert( ordered() );
+    }
+#ifdef ASSIST_HAS_CXX11
+    // Takes over b's contents, in O(1): b must already be in order
+    void adopt(sorted_equivalent_t, base_type &&b) {
+        c = std::move(b);
+        assert( ordered() );
     }
+#endif
 
     // Observers
     key_compare key_comp() const { return comparator; }
+    // Extra
+    // The counters of the Stats policy, which can be reset through
+    // the non-const one
+    Stats const &stats() const { return counters(); }
+    Stats &stats() { return counters(); }
     value_compare value_comp() const { return key_comp(); }
 
     // Set operations
@@ -173,42 +380,116 @@ class multiset_adapter {
         return edges.second-edges.first;
     }
     std::pair<iterator, iterator> equal_range(const key_type &k) {
-        return std::equal_range(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return search::equal_range(begin(), end(), k, compare());
     }
     std::pair<const_iterator, const_iterator> equal_range(const key_type &k) const {
-        return std::equal_range(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return search::equal_range(begin(), end(), k, compare());
     }
     iterator find(const key_type &k) {
-        iterator it = lower_bound(k);
-        if ( it == end() || comparator(k, *it) ) {
+        detail::lookup_probe<Stats> probe(counters());
+        iterator it = search::lower_bound(begin(), end(), k, compare());
+        if ( it == end() || compare()(k, *it) ) {
             return end();
         } else {
             return it;
         }
     }
     const_iterator find(const key_type &k) const {
-        const_iterator it = lower_bound(k);
-        if ( it == end() || comparator(k, *it) ) {
+        detail::lookup_probe<Stats> probe(counters());
+        const_iterator it = search::lower_bound(begin(), end(), k, compare());
+        if ( it == end() || compare()(k, *it) ) {
             return end();
         } else {
             return it;
         }
     }
     iterator lower_bound(const key_type &k) {
-        return std::lower_bound(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return search::lower_bound(begin(), end(), k, compare());
     }
     const_iterator lower_bound(const key_type &k) const {
-        return std::lower_bound(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return search::lower_bound(begin(), end(), k, compare());
     }
     iterator upper_bound(const key_type &k) {
-        return std::upper_bound(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return search::upper_bound(begin(), end(), k, compare());
     }
     const_iterator upper_bound(const key_type &k) const {
-        return std::upper_bound(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return search::upper_bound(begin(), end(), k, compare());
     }
     bool contains(const key_type &k) const {
-        return std::binary_search(begin(), end(), k, value_comp());
+        detail::lookup_probe<Stats> probe(counters());
+        return search::binary_search(begin(), end(), k, compare());
+    }
+#ifdef ASSIST_HAS_CXX11
+    // Heterogeneous lookup, for comparators declaring is_transparent
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    size_type count(const K &k) const {
+        std::pair<const_iterator, const_iterator> edges = equal_range(k);
+        return edges.second-edges.first;
     }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K &k) {
+        detail::lookup_probe<Stats> probe(counters());
+        return search::equal_range(begin(), end(), k, compare());
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    std::pair<const_iterator, const_iterator> equal_range(const K &k) const {
+        detail::lookup_probe<Stats> probe(counters());
+        return search::equal_range(begin(), end(), k, compare());
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    iterator find(const K &k) {
+        detail::lookup_probe<Stats> probe(counters());
+        iterator it = search::lower_bound(begin(), end(), k, compare());
+        return ( it == end() || compare()(k, *it) ) ? end() : it;
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    const_iterator find(const K &k) const {
+        detail::lookup_probe<Stats> probe(counters());
+        const_iterator it = search::lower_bound(begin(), end(), k, compare());
+        return ( it == end() || compare()(k, *it) ) ? end() : it;
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    iterator lower_bound(const K &k) {
+        detail::lookup_probe<Stats> probe(counters());
+        return search::lower_bound(begin(), end(), k, compare());
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    const_iterator lower_bound(const K &k) const {
+        detail::lookup_probe<Stats> probe(counters());
+        return search::lower_bound(begin(), end(), k, compare());
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    iterator upper_bound(const K &k) {
+        detail::lookup_probe<Stats> probe(counters());
+        return search::upper_bound(begin(), end(), k, compare());
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    const_iterator upper_bound(const K &k) const {
+        detail::lookup_probe<Stats> probe(counters());
+        return search::upper_bound(begin(), end(), k, compare());
+    }
+    template <typename K, typename C = CMP,
+              typename = typename C::is_transparent>
+    bool contains(const K &k) const {
+        detail::lookup_probe<Stats> probe(counters());
+        return search::binary_search(begin(), end(), k, compare());
+    }
+#endif
   
     // Comparison Operators
     bool operator==(multiset_adapter const &other) { return c == other.c; }
@@ -221,22 +502,22 @@ class multiset_adapter {
 
 // Overloaded Algorithms
 template < typename base_type,
-            typename CMP >
-void swap(multiset_adapter<base_type,CMP> const &lhs,
-          multiset_adapter<base_type,CMP> const &rhs) {
+            typename CMP, typename Stats >
+void swap(multiset_adapter<base_type,CMP,Stats> const &lhs,
+          multiset_adapter<base_type,CMP,Stats> const &rhs) {
     lhs.swap(rhs);
 }
 // WARNING: Not O(1)
 template < typename base_type,
-            typename CMP >
+            typename CMP, typename Stats >
 void swap(base_type const &lhs,
-          multiset_adapter<base_type,CMP> const &rhs) {
+          multiset_adapter<base_type,CMP,Stats> const &rhs) {
     lhs.swap(rhs);
 }
 // WARNING: Not O(1)
 template < typename base_type,
-            typename CMP >
-void swap(multiset_adapter<base_type,CMP> const &lhs,
+            typename CMP, typename Stats >
+void swap(multiset_adapter<base_type,CMP,Stats> const &lhs,
           base_type const &rhs) {
     lhs.swap(rhs);
 }
@@ -248,22 +529,22 @@ namespace std {
 
 // Overloaded Algorithms
 template < typename base_type,
-            typename CMP >
-void swap(assist::multiset_adapter<base_type,CMP> const &lhs,
-          assist::multiset_adapter<base_type,CMP> const &rhs) {
+            typename CMP, typename Stats >
+void swap(assist::multiset_adapter<base_type,CMP,Stats> const &lhs,
+          assist::multiset_adapter<base_type,CMP,Stats> const &rhs) {
     assist::swap(lhs,rhs);
 }
 // WARNING: Not O(1)
 template < typename base_type,
-            typename CMP >
+            typename CMP, typename Stats >
 void swap(base_type const &lhs,
-          assist::multiset_adapter<base_type,CMP> const &rhs) {
+          assist::multiset_adapter<base_type,CMP,Stats> const &rhs) {
     assist::swap(lhs,rhs);
 }
 // WARNING: Not O(1)
 template < typename base_type,
-            typename CMP >
-void swap(assist::multiset_adapter<base_type,CMP> const &lhs,
+            typename CMP, typename Stats >
+void swap(assist::multiset_adapter<base_type,CMP,Stats> const &lhs,
           base_type const &rhs) {
     assist::swap(lhs,rhs);
 }
@@ -0,0 +1,186 @@
+#ifndef ASSIST_RCU_ADAPTER_HPP
+#define ASSIST_RCU_ADAPTER_HPP
+
+/*
+ * assist/rcu_adapter.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* Read-copy-update sharing of any of the sorted adapters between
+ * threads, for data that's read all the time and written rarely.
+ * Readers pin the current version with read() and never take a lock:
+ * announcing themselves costs one compare-and-swap on a cache line of
+ * their own, and the version is one atomic load.  Writers copy the
+ * current version, change the copy (modify(), or the bulk insert and
+ * erase below), and publish it; they're serialised by a mutex.
+ *
+ * Old versions are reclaimed by epoch: each publish advances the epoch,
+ * and a version retired in epoch e is deleted by a later write once no
+ * reader announced in e or earlier is still reading.  So one reader
+ * that never lets go holds back reclamation, but never blocks writers.
+ * Readers that find every slot taken (more than rcu_slot_count live
+ * snapshots at once) count themselves in a shared overflow counter
+ * instead, and while any are reading nothing is reclaimed.
+ *
+ * Needs C++11 atomics; without ASSIST_HAS_CXX11 this header is empty.
+ */
+
+#include "detail/config.hpp"
+
+#ifdef ASSIST_HAS_CXX11
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <utility> // move
+#include <cstddef> // size_t
+
+#include "detail/rcu.hpp"
+
+namespace assist {
+
+template < typename adapter_type >
+class rcu_adapter {
+  public:
+    // Types
+    typedef adapter_type adapter;
+    typedef typename adapter_type::key_type key_type;
+    typedef typename adapter_type::value_type value_type;
+    typedef typename adapter_type::size_type size_type;
+
+  private:
+    struct retired {
+        adapter_type const *version;
+        unsigned long long epoch;
+    };
+
+    std::atomic<adapter_type const *> current;
+    mutable detail::rcu_epochs readers;
+    // Writers only, under the mutex
+    std::mutex writer;
+    std::vector<retired> limbo;
+
+    // Deletes the retired versions no reader can still be using
+    void reclaim() {
+        unsigned long long const oldest = readers.oldest();
+        std::size_t kept = 0;
+        for ( std::size_t i = 0; i != limbo.size(); ++i ) {
+            if ( oldest <= limbo[i].epoch ) {
+                limbo[kept++] = limbo[i];
+            } else {
+                delete limbo[i].version;
+            }
+        }
+        limbo.resize(kept);
+    }
+    // Call with the mutex held
+    void publish(adapter_type *next) {
+        adapter_type const *const old = current.exchange(next);
+        retired r = { old, readers.advance() };
+        limbo.push_back(r);
+        reclaim();
+    }
+
+  public:
+    // A pinned version; it stays valid, and unchanged, until destroyed
+    class snapshot {
+        rcu_adapter const *owner;
+        std::size_t slot;
+        adapter_type const *version;
+        friend class rcu_adapter;
+        snapshot(rcu_adapter const &r)
+         : owner(&r), slot(r.readers.enter()),
+           version(r.current.load()) {}
+      public:
+        snapshot(snapshot &&other)
+         : owner(other.owner), slot(other.slot), version(other.version) {
+            other.owner = 0;
+        }
+        snapshot &operator=(snapshot &&other) {
+            std::swap( owner, other.owner );
+            std::swap( slot, other.slot );
+            std::swap( version, other.version );
+            return *this;
+        }
+        snapshot(snapshot const &) = delete;
+        snapshot &operator=(snapshot const &) = delete;
+        ~snapshot() { if ( owner ) owner->readers.leave(slot); }
+
+        adapter_type const &operator*() const { return *version; }
+        adapter_type const *operator->() const { return version; }
+        adapter_type const &get() const { return *version; }
+    };
+
+    // Construct/Copy/Destroy
+    explicit rcu_adapter(adapter_type const &initial = adapter_type())
+     : current(new adapter_type(initial)) {}
+    explicit rcu_adapter(adapter_type &&initial)
+     : current(new adapter_type(std::move(initial))) {}
+    rcu_adapter(rcu_adapter const &) = delete;
+    rcu_adapter &operator=(rcu_adapter const &) = delete;
+    // No snapshot may outlive the rcu_adapter
+    ~rcu_adapter() {
+        for ( std::size_t i = 0; i != limbo.size(); ++i ) {
+            delete limbo[i].version;
+        }
+        delete current.load();
+    }
+
+    snapshot read() const { return snapshot(*this); }
+
+    // Capacity
+    bool empty() const { return read()->empty(); }
+    size_type size() const { return read()->size(); }
+
+    // Modifiers
+    // Calls f on a copy of the current version, then publishes the copy.
+    // If f throws, nothing is published.
+    template <class F>
+    void modify(F f) {
+        std::lock_guard<std::mutex> lock(writer);
+        adapter_type *next = new adapter_type(*current.load());
+        try {
+            f(*next);
+        } catch (...) {
+            delete next;
+            throw;
+        }
+        publish(next);
+    }
+    // Publishes a whole new version
+    void assign(adapter_type a) {
+        std::lock_guard<std::mutex> lock(writer);
+        publish(new adapter_type(std::move(a)));
+    }
+    // A batch goes through the adapter's bulk insert, in one version
+    template <class InputIterator>
+    void insert(InputIterator b, InputIterator e) {
+        modify([&](adapter_type &a) { a.insert(b, e); });
+    }
+    size_type erase(const key_type &k) {
+        size_type n = 0;
+        modify([&](adapter_type &a) {
+            typedef typename adapter_type::iterator iterator;
+            std::pair<iterator, iterator> r = a.equal_range(k);
+            n = r.second - r.first;
+            a.erase(r.first, r.second);
+        });
+        return n;
+    }
+    void clear() { assign(adapter_type(read()->key_comp())); }
+
+    // Set operations
+    size_type count(const key_type &k) const { return read()->count(k); }
+    bool contains(const key_type &k) const { return read()->contains(k); }
+};
+
+} // namespace assist
+
+#endif // ASSIST_HAS_CXX11
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef ASSIST_SET_ALGORITHM_HPP
+#define ASSIST_SET_ALGORITHM_HPP
+
+/*
+ * assist/set_algorithm.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* Set algebra between two adapters of the same type, any of the four.
+ * The results are those of the std::set_* algorithms, so for the
+ * multi adapters an element appearing m and n times appears max(m,n)
+ * times in the union, min(m,n) in the intersection and max(m-n,0) in
+ * the difference; where both sides have an equivalent element, the
+ * one from lhs is kept.  The merged output is already in order, so it
+ * is swapped straight into the result without being checked or sorted.
+ *
+ * Skewed sizes gallop through the longer side instead of merging, and
+ * integer set_adapters are intersected with SSE2 where available.
+ */
+
+#include <iterator> // back_inserter
+
+#include "detail/config.hpp"
+#include "detail/adapter_traits.hpp"
+#include "detail/set_algorithm.hpp"
+
+namespace assist {
+
+namespace detail {
+
+#define ASSIST_DETAIL_DEFINE_SET_OPERATION(NAME, RESERVE) \
+template < typename adapter_type, typename base_type > \
+void NAME(adapter_type const &lhs, base_type const &l, base_type const &r, \
+          adapter_type &result) { \
+    typedef set_kernels< base_type, typename adapter_type::value_compare, \
+                         is_unique_adapter<adapter_type>::value > kernels; \
+    base_type c(l.get_allocator()); \
+    c.reserve(RESERVE); \
+    kernels::NAME(l.begin(), l.end(), r.begin(), r.end(), \
+                  std::back_inserter(c), lhs.value_comp()); \
+    result.swap(typename sorted_tag<adapter_type>::type(), c); \
+}
+ASSIST_DETAIL_DEFINE_SET_OPERATION( set_union, l.size()+r.size() )
+ASSIST_DETAIL_DEFINE_SET_OPERATION( set_intersection,
+                                    l.size() < r.size() ? l.size() : r.size() )
+ASSIST_DETAIL_DEFINE_SET_OPERATION( set_difference, l.size() )
+ASSIST_DETAIL_DEFINE_SET_OPERATION( set_symmetric_difference,
+                                    l.size()+r.size() )
+#undef ASSIST_DETAIL_DEFINE_SET_OPERATION
+
+} // namespace detail
+
+// Each returns a new adapter, using lhs's comparator.
+// The inplace_ forms replace lhs's contents instead; they're strongly
+// exception safe as long as the comparator doesn't throw.
+#define ASSIST_DETAIL_DEFINE_SET_OPERATION(NAME) \
+template < typename adapter_type > \
+adapter_type NAME(adapter_type const &lhs, adapter_type const &rhs) { \
+    adapter_type result(lhs.key_comp()); \
+    detail::NAME(lhs, lhs.base(), rhs.base(), result); \
+    return result; \
+} \
+template < typename adapter_type > \
+void inplace_##NAME(adapter_type &lhs, adapter_type const &rhs) { \
+    detail::NAME(lhs, lhs.base(), rhs.base(), lhs); \
+}
+ASSIST_DETAIL_DEFINE_SET_OPERATION( set_union )
+ASSIST_DETAIL_DEFINE_SET_OPERATION( set_intersection )
+ASSIST_DETAIL_DEFINE_SET_OPERATION( set_difference )
+ASSIST_DETAIL_DEFINE_SET_OPERATION( set_symmetric_difference )
+#undef ASSIST_DETAIL_DEFINE_SET_OPERATION
+
+} // namespace assist
+
+#endif
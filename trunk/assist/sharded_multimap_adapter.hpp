@@ -0,0 +1,385 @@
+#ifndef ASSIST_SHARDED_MULTIMAP_ADAPTER_HPP
+#define ASSIST_SHARDED_MULTIMAP_ADAPTER_HPP
+
+/*
+ * assist/sharded_multimap_adapter.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* A multimap_adapter split by key range into shards, each with its own
+ * lock, so threads inserting into different parts of the key space
+ * don't wait for each other, and each insert only shifts the tail of
+ * one shard.  All the elements with one key are always in one shard.
+ *
+ * When a shard grows well past its share, the split points are redrawn
+ * at the quantiles of the keys (rebalance() does it on demand).  That
+ * briefly locks every shard; operations that raced with it retry on the
+ * new shards.  Rebalancing waits for the total to grow by half since
+ * the last time, so a single hot key can't make it run on every insert.
+ * The shards are found under an epoch guard, as in rcu_adapter, so an
+ * operation writes nothing shared but its own shard, and a replaced
+ * layout is freed once nothing can still be looking at it.
+ *
+ * There are no iterators, since they'd have nothing to hold on to:
+ * for_each() visits in order, a shard at a time, and merged() copies
+ * out everything at once.
+ *
+ * Needs C++11 threads; without ASSIST_HAS_CXX11 this header is empty.
+ */
+
+#include "detail/config.hpp"
+
+#ifdef ASSIST_HAS_CXX11
+
+#include <vector>
+#include <memory> // unique_ptr
+#include <mutex>
+#include <atomic>
+#include <thread> // hardware_concurrency
+#include <algorithm> // upper_bound
+#include <functional> // less
+#include <utility> // pair
+
+#include "multimap_adapter.hpp"
+#include "tags.hpp"
+#include "detail/rcu.hpp"
+
+namespace assist {
+
+template < typename base_type,
+            typename CMP = std::less<typename base_type::value_type
+                                                         ::first_type> >
+class sharded_multimap_adapter {
+  public:
+    // Types
+    typedef multimap_adapter<base_type, CMP> shard_type;
+    typedef typename shard_type::key_type key_type;
+    typedef typename shard_type::mapped_type mapped_type;
+    typedef typename shard_type::value_type value_type;
+    typedef typename shard_type::key_compare key_compare;
+    typedef typename shard_type::value_compare value_compare;
+    typedef typename shard_type::size_type size_type;
+
+  private:
+    struct shard {
+        std::mutex lock;
+        shard_type data;
+        // moved into a newer layout; look again
+        bool retired;
+        explicit shard(key_compare const &cmp) : data(cmp), retired(false) {}
+    };
+    struct layout {
+        // shard i holds the keys in [splits[i-1], splits[i])
+        std::vector<key_type> splits;
+        std::vector< std::unique_ptr<shard> > shards;
+    };
+
+    struct retired {
+        layout const *old;
+        unsigned long long epoch;
+    };
+
+    // Read under an rcu_guard, so an operation pays one uncontended
+    // compare-and-swap on a slot of its own, not a shared refcount
+    std::atomic<layout *> current;
+    mutable detail::rcu_epochs readers;
+    std::mutex rebalancing;
+    // Layouts replaced by a rebalance, under rebalancing
+    std::vector<retired> limbo;
+    std::atomic<size_type> total;
+    // total at the last rebalance
+    size_type rebalanced_at;
+    size_type const wanted_shards;
+    key_compare comparator;
+
+    // Shards smaller than this are never worth rebalancing
+    static size_type const min_shard_size = 1 << 12;
+
+    // Deletes the replaced layouts no operation can still be using;
+    // call with rebalancing held
+    void reclaim() {
+        unsigned long long const oldest = readers.oldest();
+        std::size_t kept = 0;
+        for ( std::size_t i = 0; i != limbo.size(); ++i ) {
+            if ( oldest <= limbo[i].epoch ) {
+                limbo[kept++] = limbo[i];
+            } else {
+                delete limbo[i].old;
+            }
+        }
+        limbo.resize(kept);
+    }
+    size_type shard_of(layout const &l, key_type const &k) const {
+        return std::upper_bound(l.splits.begin(), l.splits.end(),
+                                k, comparator) - l.splits.begin();
+    }
+    // Calls f on the data of the shard holding k, with it locked
+    template <class F>
+    void with_shard(key_type const &k, F f) const {
+        for ( ;; ) {
+            detail::rcu_guard const pin(readers);
+            layout const *const l = current.load();
+            shard &s = *l->shards[shard_of(*l, k)];
+            std::lock_guard<std::mutex> guard(s.lock);
+            if ( s.retired ) continue;
+            f(s.data);
+            return;
+        }
+    }
+
+    // Call with rebalancing held
+    void redraw() {
+        layout *const old = current.load();
+        std::vector< std::unique_lock<std::mutex> > locks;
+        for ( size_type i = 0; i != old->shards.size(); ++i ) {
+            locks.push_back(std::unique_lock<std::mutex>(old->shards[i]->lock));
+        }
+        // the shards are in key order, so this is sorted
+        base_type all;
+        for ( size_type i = 0; i != old->shards.size(); ++i ) {
+            shard_type &d = old->shards[i]->data;
+            all.insert(all.end(), d.begin(), d.end());
+        }
+
+        std::unique_ptr<layout> next(new layout);
+        value_compare const vcmp(comparator);
+        for ( size_type i = 1; i < wanted_shards && !all.empty(); ++i ) {
+            key_type const &k = all[all.size()*i/wanted_shards].first;
+            // the same key twice would make an empty shard
+            if ( next->splits.empty() || comparator(next->splits.back(), k) ) {
+                next->splits.push_back(k);
+            }
+        }
+        typename base_type::iterator b = all.begin();
+        for ( size_type i = 0; i <= next->splits.size(); ++i ) {
+            typename base_type::iterator const e =
+                i == next->splits.size() ? all.end()
+                : std::lower_bound(b, all.end(), next->splits[i], vcmp);
+            next->shards.push_back(std::unique_ptr<shard>(new shard(comparator)));
+            base_type part(b, e);
+            next->shards.back()->data.adopt(sorted_equivalent, std::move(part));
+            b = e;
+        }
+
+        for ( size_type i = 0; i != old->shards.size(); ++i ) {
+            old->shards[i]->retired = true;
+            old->shards[i]->data.clear();
+        }
+        current.store(next.release());
+        retired const r = { old, readers.advance() };
+        limbo.push_back(r);
+        rebalanced_at = all.size();
+        // the old shards unlock, sending anyone waiting to the new,
+        // and only then may the old layout go
+        locks.clear();
+        reclaim();
+    }
+    // After an insert left a shard holding n
+    void maybe_rebalance(size_type n) {
+        size_type const t = total.load(std::memory_order_relaxed);
+        if ( n < min_shard_size || n <= t/wanted_shards*3/2 ) return;
+        std::unique_lock<std::mutex> guard(rebalancing, std::try_to_lock);
+        if ( guard && t >= rebalanced_at + rebalanced_at/2 ) redraw();
+    }
+
+  public:
+    // Construct/Copy/Destroy
+    explicit sharded_multimap_adapter(size_type shards = 0,
+                                      const key_compare &cmp = key_compare())
+     : current(new layout), total(0), rebalanced_at(0),
+       wanted_shards(shards ? shards
+                     : std::max(1u, std::thread::hardware_concurrency())),
+       comparator(cmp) {
+        current.load()->shards.push_back(
+            std::unique_ptr<shard>(new shard(cmp)));
+    }
+    // Splits the initial contents evenly across the shards
+    template <class InputIterator>
+    sharded_multimap_adapter(InputIterator b, InputIterator e,
+                             size_type shards = 0,
+                             const key_compare &cmp = key_compare())
+     : current(new layout), total(0), rebalanced_at(0),
+       wanted_shards(shards ? shards
+                     : std::max(1u, std::thread::hardware_concurrency())),
+       comparator(cmp) {
+        layout *const l = current.load();
+        l->shards.push_back(std::unique_ptr<shard>(new shard(cmp)));
+        l->shards[0]->data.insert(b, e);
+        total = l->shards[0]->data.size();
+        std::lock_guard<std::mutex> guard(rebalancing);
+        redraw();
+    }
+    sharded_multimap_adapter(sharded_multimap_adapter const &) = delete;
+    sharded_multimap_adapter &operator=(sharded_multimap_adapter const &) = delete;
+    // Nothing may be using it
+    ~sharded_multimap_adapter() {
+        for ( std::size_t i = 0; i != limbo.size(); ++i ) {
+            delete limbo[i].old;
+        }
+        delete current.load();
+    }
+
+    // Copies everything out, in order, as of one moment
+    shard_type merged() const {
+        detail::rcu_guard const pin(readers);
+        layout const *l;
+        std::vector< std::unique_lock<std::mutex> > locks;
+        for ( bool retry = true; retry; ) {
+            l = current.load();
+            locks.clear();
+            retry = false;
+            for ( size_type i = 0; i != l->shards.size(); ++i ) {
+                locks.push_back(std::unique_lock<std::mutex>(l->shards[i]->lock));
+                retry = retry || l->shards[i]->retired;
+            }
+        }
+        base_type all;
+        for ( size_type i = 0; i != l->shards.size(); ++i ) {
+            shard_type const &d = l->shards[i]->data;
+            all.insert(all.end(), d.begin(), d.end());
+        }
+        shard_type m(comparator);
+        m.adopt(sorted_equivalent, std::move(all));
+        return m;
+    }
+    // Calls f on every element in order, locking a shard at a time;
+    // f mustn't call back into this adapter.
+    template <class F>
+    void for_each(F f) const {
+        // everything below *from has been visited
+        std::unique_ptr<key_type const> from;
+        for ( ;; ) {
+            detail::rcu_guard const pin(readers);
+            layout const *const l = current.load();
+            size_type i = from ? shard_of(*l, *from) : 0;
+            for ( ; i != l->shards.size(); ++i ) {
+                std::lock_guard<std::mutex> guard(l->shards[i]->lock);
+                // rebalanced away; carry on from *from in the new shards
+                if ( l->shards[i]->retired ) break;
+                shard_type const &d = l->shards[i]->data;
+                typename shard_type::const_iterator it =
+                    from ? d.lower_bound(*from) : d.begin();
+                for ( ; it != d.end(); ++it ) f(*it);
+                if ( i == l->splits.size() ) return;
+                from.reset(new key_type(l->splits[i]));
+            }
+        }
+    }
+
+    // Capacity
+    bool empty() const { return size() == 0; }
+    size_type size() const { return total.load(std::memory_order_relaxed); }
+    // Extra
+    size_type shard_count() const {
+        detail::rcu_guard const pin(readers);
+        return current.load()->shards.size();
+    }
+
+    // Modifiers
+    void insert(const value_type &v) {
+        size_type n = 0;
+        with_shard(v.first, [&](shard_type &d) {
+            d.insert(v);
+            n = d.size();
+        });
+        total.fetch_add(1, std::memory_order_relaxed);
+        maybe_rebalance(n);
+    }
+    // Sorts the batch out by shard, then bulk inserts into each
+    template <class InputIterator>
+    void insert(InputIterator b, InputIterator const e) {
+        std::vector<value_type> pending(b, e);
+        size_type largest = 0;
+        while ( !pending.empty() ) {
+            detail::rcu_guard const pin(readers);
+            layout const *const l = current.load();
+            std::vector< std::vector<value_type> > buckets(l->shards.size());
+            for ( size_type i = 0; i != pending.size(); ++i ) {
+                buckets[shard_of(*l, pending[i].first)].push_back(pending[i]);
+            }
+            std::vector<value_type> retry;
+            for ( size_type i = 0; i != buckets.size(); ++i ) {
+                if ( buckets[i].empty() ) continue;
+                shard &s = *l->shards[i];
+                std::lock_guard<std::mutex> guard(s.lock);
+                if ( s.retired ) {
+                    retry.insert(retry.end(),
+                                 buckets[i].begin(), buckets[i].end());
+                    continue;
+                }
+                s.data.insert(buckets[i].begin(), buckets[i].end());
+                total.fetch_add(buckets[i].size(), std::memory_order_relaxed);
+                largest = std::max(largest, s.data.size());
+            }
+            pending.swap(retry);
+        }
+        maybe_rebalance(largest);
+    }
+    size_type erase(const key_type &k) {
+        size_type n = 0;
+        with_shard(k, [&](shard_type &d) {
+            typedef typename shard_type::iterator iterator;
+            std::pair<iterator, iterator> r = d.equal_range(k);
+            n = r.second - r.first;
+            d.erase(r.first, r.second);
+        });
+        total.fetch_sub(n, std::memory_order_relaxed);
+        return n;
+    }
+    void clear() {
+        // the layout can't change while this is held
+        std::lock_guard<std::mutex> guard(rebalancing);
+        layout const *const l = current.load();
+        for ( size_type i = 0; i != l->shards.size(); ++i ) {
+            std::lock_guard<std::mutex> g(l->shards[i]->lock);
+            total.fetch_sub(l->shards[i]->data.size(),
+                            std::memory_order_relaxed);
+            l->shards[i]->data.clear();
+        }
+    }
+    // Redraws the split points at the quantiles of the current keys
+    void rebalance() {
+        std::lock_guard<std::mutex> guard(rebalancing);
+        redraw();
+    }
+
+    // Observers
+    key_compare key_comp() const { return comparator; }
+    value_compare value_comp() const { return value_compare(comparator); }
+
+    // Set operations
+    size_type count(const key_type &k) const {
+        size_type n = 0;
+        with_shard(k, [&](shard_type &d) { n = d.count(k); });
+        return n;
+    }
+    bool contains(const key_type &k) const {
+        bool found = false;
+        with_shard(k, [&](shard_type &d) { found = d.contains(k); });
+        return found;
+    }
+    // Copies the elements with key k to out, in order
+    template <class OutputIterator>
+    OutputIterator copy_equal_range(const key_type &k,
+                                    OutputIterator out) const {
+        with_shard(k, [&](shard_type &d) {
+            typedef typename shard_type::const_iterator const_iterator;
+            std::pair<const_iterator, const_iterator> r =
+                static_cast<shard_type const &>(d).equal_range(k);
+            out = std::copy(r.first, r.second, out);
+        });
+        return out;
+    }
+
+};
+
+} // namespace assist
+
+#endif // ASSIST_HAS_CXX11
+
+#endif
@@ -0,0 +1,404 @@
+#ifndef ASSIST_SMALL_VECTOR_HPP
+#define ASSIST_SMALL_VECTOR_HPP
+
+/*
+ * assist/small_vector.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* A vector that keeps up to N elements inside itself, and only goes to
+ * the allocator once it outgrows them.  As the base_type of an adapter
+ * that rarely holds more than a handful of elements, it makes building
+ * and destroying one free of allocation:
+ *
+ *     set_adapter< small_vector<int, 16> > s;
+ *
+ * It has the parts of the std::vector interface the adapters use, and
+ * the usual ones besides, but not the (count, value) overloads of the
+ * constructor, assign and insert.  Unlike std::vector, swapping and
+ * moving copy the elements when they're stored inline, so those don't
+ * keep iterators valid.  Elements are aligned no more strictly than
+ * the fundamental types.
+ */
+
+#include <memory> // allocator, allocator_traits
+#include <iterator> // reverse_iterator
+#include <algorithm> // copy, copy_backward, rotate, equal,
+                     // lexicographical_compare, swap
+#include <functional> // less
+#include <stdexcept> // out_of_range
+#include <new> // placement new
+#include <cstddef> // size_t, ptrdiff_t
+
+#include "detail/config.hpp"
+#include "detail/sorted_search.hpp"
+
+#ifdef ASSIST_HAS_CXX11
+#include <utility> // move, forward
+#endif
+
+namespace assist {
+
+namespace detail {
+
+// As strictly aligned as any fundamental type
+union max_align {
+    long double ld;
+    double d;
+    long l;
+    void *p;
+    void (*f)();
+};
+
+} // namespace detail
+
+template < typename T, std::size_t N,
+            typename Allocator = std::allocator<T> >
+class small_vector {
+  public:
+    // Types
+    typedef T value_type;
+    typedef Allocator allocator_type;
+    typedef T &reference;
+    typedef T const &const_reference;
+    typedef T *pointer;
+    typedef T const *const_pointer;
+    typedef T *iterator;
+    typedef T const *const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    static size_type const inline_capacity = N;
+
+  private:
+    union storage {
+        char bytes[(N ? N : 1) * sizeof(T)];
+        detail::max_align align;
+    };
+
+    allocator_type alloc;
+    T *first;
+    T *last;
+    T *stop;
+    storage buffer;
+
+    T *local() { return reinterpret_cast<T *>(buffer.bytes); }
+    T const *local() const { return reinterpret_cast<T const *>(buffer.bytes); }
+
+#ifdef ASSIST_HAS_CXX11
+    static T &&take(T &v) { return std::move(v); }
+#else
+    static T const &take(T &v) { return v; }
+#endif
+    static void destroy(T *b, T *e) {
+        for ( ; b != e; ++b ) b->~T();
+    }
+    // Back to empty and inline, with everything freed
+    void release() {
+        destroy(first, last);
+        if ( on_heap() ) alloc.deallocate(first, capacity());
+        first = last = local();
+        stop = local() + N;
+    }
+    void steal(small_vector &other) {
+        first = other.first;
+        last = other.last;
+        stop = other.stop;
+        other.first = other.last = other.local();
+        other.stop = other.local() + N;
+    }
+    // Moves the elements to storage for cap of them; inline if they fit
+    void reallocate(size_type cap) {
+        T *const fresh = cap <= N ? local() : alloc.allocate(cap);
+        if ( fresh == first ) return;
+        T *out = fresh;
+        try {
+            for ( T *p = first; p != last; ++p, ++out ) {
+                ::new(static_cast<void *>(out)) T(take(*p));
+            }
+        } catch (...) {
+            destroy(fresh, out);
+            if ( fresh != local() ) alloc.deallocate(fresh, cap);
+            throw;
+        }
+        destroy(first, last);
+        if ( on_heap() ) alloc.deallocate(first, capacity());
+        first = fresh;
+        last = out;
+        stop = fresh + (cap <= N ? N : cap);
+    }
+    void grow() {
+        size_type const cap = capacity();
+        reallocate(cap ? 2*cap : 1);
+    }
+    // Puts v at pos, moving from it
+    iterator place(iterator pos, T &v) {
+        size_type const i = pos - first;
+        if ( last == stop ) grow();
+        pos = first + i;
+        if ( pos == last ) {
+            ::new(static_cast<void *>(last)) T(take(v));
+        } else {
+            ::new(static_cast<void *>(last)) T(take(last[-1]));
+#ifdef ASSIST_HAS_CXX11
+            std::move_backward(pos, last-1, last);
+#else
+            std::copy_backward(pos, last-1, last);
+#endif
+            *pos = take(v);
+        }
+        ++last;
+        return pos;
+    }
+
+  public:
+    // Construct/Copy/Destroy
+    explicit small_vector(const allocator_type &a = allocator_type())
+     : alloc(a), first(local()), last(local()), stop(local() + N) {}
+    template <class InputIterator>
+    small_vector(InputIterator b, InputIterator e,
+                 const allocator_type &a = allocator_type())
+     : alloc(a), first(local()), last(local()), stop(local() + N) {
+        try {
+            insert(end(), b, e);
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+    small_vector(small_vector const &other)
+     : alloc(other.alloc), first(local()), last(local()), stop(local() + N) {
+        try {
+            reserve(other.size());
+            for ( ; last != first + other.size(); ++last ) {
+                ::new(static_cast<void *>(last)) T(other.first[last-first]);
+            }
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+    small_vector &operator=(small_vector const &other) {
+        if ( this != &other ) {
+            clear();
+            reserve(other.size());
+            for ( ; last != first + other.size(); ++last ) {
+                ::new(static_cast<void *>(last)) T(other.first[last-first]);
+            }
+        }
+        return *this;
+    }
+#ifdef ASSIST_HAS_CXX11
+    small_vector(small_vector &&other)
+     : alloc(std::move(other.alloc)),
+       first(local()), last(local()), stop(local() + N) {
+        if ( other.on_heap() ) {
+            steal(other);
+        } else {
+            for ( ; last != first + other.size(); ++last ) {
+                ::new(static_cast<void *>(last))
+                    T(std::move(other.first[last-first]));
+            }
+            other.clear();
+        }
+    }
+    small_vector &operator=(small_vector &&other) {
+        if ( this == &other ) return *this;
+        release();
+        if ( other.on_heap() ) {
+            alloc = std::move(other.alloc);
+            steal(other);
+        } else {
+            for ( ; last != first + other.size(); ++last ) {
+                ::new(static_cast<void *>(last))
+                    T(std::move(other.first[last-first]));
+            }
+            other.clear();
+        }
+        return *this;
+    }
+#endif
+    ~small_vector() { release(); }
+
+    allocator_type get_allocator() const { return alloc; }
+
+    // Iterators
+    iterator begin() { return first; }
+    const_iterator begin() const { return first; }
+    iterator end() { return last; }
+    const_iterator end() const { return last; }
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    // Capacity
+    bool empty() const { return first == last; }
+    size_type size() const { return last - first; }
+    size_type max_size() const {
+#ifdef ASSIST_HAS_CXX11
+        // std::allocator lost its max_size() in C++20
+        return std::allocator_traits<allocator_type>::max_size(alloc);
+#else
+        return alloc.max_size();
+#endif
+    }
+    size_type capacity() const { return stop - first; }
+    void reserve(size_type n) {
+        if ( n > capacity() ) reallocate(n);
+    }
+    // Moves back inline if the elements fit there
+    void shrink_to_fit() {
+        if ( on_heap() && size() != capacity() ) reallocate(size());
+    }
+    void resize(size_type n, T const &v = T()) {
+        if ( n <= size() ) {
+            erase(first + n, last);
+            return;
+        }
+        T const t(v);
+        reserve(n);
+        for ( ; last != first + n; ++last ) {
+            ::new(static_cast<void *>(last)) T(t);
+        }
+    }
+    // Extra
+    bool on_heap() const { return first != local(); }
+
+    // Element Access
+    reference operator[](size_type i) { return first[i]; }
+    const_reference operator[](size_type i) const { return first[i]; }
+    reference at(size_type i) {
+        if ( i >= size() ) throw std::out_of_range("assist: small_vector::at");
+        return first[i];
+    }
+    const_reference at(size_type i) const {
+        if ( i >= size() ) throw std::out_of_range("assist: small_vector::at");
+        return first[i];
+    }
+    reference front() { return *first; }
+    const_reference front() const { return *first; }
+    reference back() { return last[-1]; }
+    const_reference back() const { return last[-1]; }
+    T *data() { return first; }
+    T const *data() const { return first; }
+
+    // Modifiers
+    void push_back(T const &v) {
+        if ( last == stop ) {
+            // v might be in here
+            T t(v);
+            grow();
+            ::new(static_cast<void *>(last)) T(take(t));
+        } else {
+            ::new(static_cast<void *>(last)) T(v);
+        }
+        ++last;
+    }
+    void pop_back() { (--last)->~T(); }
+    iterator insert(iterator pos, T const &v) {
+        T t(v);
+        return place(pos, t);
+    }
+#ifdef ASSIST_HAS_CXX11
+    void push_back(T &&v) {
+        T t(std::move(v));
+        if ( last == stop ) grow();
+        ::new(static_cast<void *>(last)) T(std::move(t));
+        ++last;
+    }
+    template <class... Args>
+    void emplace_back(Args &&...args) {
+        push_back(T(std::forward<Args>(args)...));
+    }
+    iterator insert(iterator pos, T &&v) {
+        T t(std::move(v));
+        return place(pos, t);
+    }
+    template <class... Args>
+    iterator emplace(iterator pos, Args &&...args) {
+        T t(std::forward<Args>(args)...);
+        return place(pos, t);
+    }
+#endif
+    // Appends, then rotates into place, so input iterators work too
+    template <class InputIterator>
+    void insert(iterator pos, InputIterator b, InputIterator e) {
+        size_type const i = pos - first, before_size = size();
+        for ( ; b != e; ++b ) push_back(*b);
+        std::rotate(first + i, first + before_size, last);
+    }
+    iterator erase(iterator pos) {
+        return erase(pos, pos+1);
+    }
+    iterator erase(iterator b, iterator e) {
+        if ( b == e ) return b;
+#ifdef ASSIST_HAS_CXX11
+        T *const end = std::move(e, last, b);
+#else
+        T *const end = std::copy(e, last, b);
+#endif
+        destroy(end, last);
+        last = end;
+        return b;
+    }
+    void clear() {
+        destroy(first, last);
+        last = first;
+    }
+    void swap(small_vector &other) {
+        if ( on_heap() && other.on_heap() ) {
+            std::swap( alloc, other.alloc );
+            std::swap( first, other.first );
+            std::swap( last, other.last );
+            std::swap( stop, other.stop );
+            return;
+        }
+#ifdef ASSIST_HAS_CXX11
+        small_vector t(std::move(other));
+        other = std::move(*this);
+        *this = std::move(t);
+#else
+        small_vector t(other);
+        other = *this;
+        *this = t;
+#endif
+    }
+
+    // Comparison Operators
+    bool operator==(small_vector const &other) const {
+        return size() == other.size() && std::equal(begin(), end(), other.begin());
+    }
+    bool operator!=(small_vector const &other) const { return !(*this == other); }
+    bool operator<(small_vector const &other) const {
+        return std::lexicographical_compare(begin(), end(),
+                                            other.begin(), other.end());
+    }
+    bool operator<=(small_vector const &other) const { return !(other < *this); }
+    bool operator>(small_vector const &other) const { return other < *this; }
+    bool operator>=(small_vector const &other) const { return !(*this < other); }
+};
+
+namespace detail {
+// Contiguous, so integer keys get the vectorised searches too
+template < typename T, std::size_t N, typename A >
+struct sorted_search< small_vector<T, N, A>, std::less<T> >
+ : simd_search<T> {};
+} // namespace detail
+
+// Overloaded Algorithms
+template < typename T, std::size_t N, typename A >
+void swap(small_vector<T, N, A> &lhs, small_vector<T, N, A> &rhs) {
+    lhs.swap(rhs);
+}
+
+} // namespace assist
+
+#endif
@@ -0,0 +1,384 @@
+#ifndef ASSIST_SPLIT_MAP_ADAPTER_HPP
+#define ASSIST_SPLIT_MAP_ADAPTER_HPP
+
+/*
+ * assist/split_map_adapter.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* A map_adapter that keeps the keys and the mapped values in two
+ * parallel containers, so searches only pull keys through the cache;
+ * with large mapped values that's many more keys per line fetched.
+ * Integer keys in a std::vector also get the vectorised searches.
+ *
+ * Iterators dereference to a pair of references (key const), so
+ * it->first and it->second work, but value_type& can't be had.
+ *
+ * WARNING: Not exception-safe in the face of
+ * ordering predicates that throw exceptions.
+ */
+
+#include <utility> // pair
+#include <iterator> // reverse_iterator
+#include <algorithm> // equal, lexicographical_compare
+#include <functional> // less
+#include <cassert>
+
+#include "detail/config.hpp"
+#include "detail/sorted_search.hpp"
+#include "detail/zip_iterator.hpp"
+#include "detail/adapter_traits.hpp"
+#include "tags.hpp"
+
+namespace assist {
+
+template < typename key_container, typename mapped_container,
+            typename CMP = std::less<typename key_container::value_type> >
+class split_map_adapter {
+  public:
+    // Types
+    typedef typename key_container::value_type key_type;
+    typedef typename mapped_container::value_type mapped_type;
+    typedef std::pair<key_type, mapped_type> value_type;
+    typedef CMP key_compare;
+    struct value_compare {
+        key_compare key_comparator;
+        value_compare(key_compare kcmp) : key_comparator(kcmp) {}
+        // any pairs, so references from the iterators work too
+        template <typename L, typename R>
+        bool operator()(L const &lhs, R const &rhs) const {
+            return key_comparator(lhs.first, rhs.first);
+        }
+    };
+    typedef key_container key_container_type;
+    typedef mapped_container mapped_container_type;
+    typedef typename key_container::size_type size_type;
+    typedef typename key_container::difference_type difference_type;
+    typedef detail::zip_iterator< typename key_container::const_iterator,
+                                  typename mapped_container::iterator >
+        iterator;
+    typedef detail::zip_iterator< typename key_container::const_iterator,
+                                  typename mapped_container::const_iterator >
+        const_iterator;
+    typedef typename iterator::reference reference;
+    typedef typename const_iterator::reference const_reference;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  private:
+    key_container kc;
+    mapped_container mc;
+    CMP comparator;
+    // only the keys are ever searched
+    typedef detail::sorted_search<key_container, CMP> search;
+    typedef typename key_container::const_iterator key_iterator;
+
+    // Whether the keys are sorted, with no two equivalent
+    bool ordered() const {
+        return std::adjacent_find(kc.begin(), kc.end(),
+                   detail::negated_compare<CMP>(comparator)) == kc.end();
+    }
+    iterator at(key_iterator it) {
+        return iterator(it, mc.begin() + (it - kc.begin()));
+    }
+    const_iterator at(key_iterator it) const {
+        return const_iterator(it, mc.begin() + (it - kc.begin()));
+    }
+    // Where k belongs, trusting hint if it's right
+    key_iterator locate(const_iterator hint, const key_type &k) const {
+        key_iterator const it = hint.key_iterator();
+        if ( ( it == kc.begin() || comparator(*(it-1), k) ) &&
+             ( it == kc.end() || !comparator(*it, k) ) ) {
+            return it;
+        }
+        return search::lower_bound(kc.begin(), kc.end(), k, comparator);
+    }
+    // Inserts at it unless k is already there
+    std::pair<iterator, bool> insert_at(key_iterator it, const value_type &v) {
+        difference_type const i = it - kc.begin();
+        if ( it != kc.end() && !comparator(v.first, *it) ) {
+            return std::make_pair(at(it), false);
+        }
+        kc.insert(kc.begin()+i, v.first);
+        try {
+            mc.insert(mc.begin()+i, v.second);
+        } catch (...) {
+            kc.erase(kc.begin()+i);
+            throw;
+        }
+        return std::make_pair(begin()+i, true);
+    }
+#ifdef ASSIST_HAS_CXX11
+    // Constructs the mapped value at it, for a k that isn't there yet
+    template <class... Args>
+    iterator emplace_at(key_iterator it, const key_type &k, Args &&...args) {
+        difference_type const i = it - kc.begin();
+        kc.insert(kc.begin()+i, k);
+        try {
+            mc.emplace(mc.begin()+i, std::forward<Args>(args)...);
+        } catch (...) {
+            kc.erase(kc.begin()+i);
+            throw;
+        }
+        return begin()+i;
+    }
+#endif
+
+  public:
+    // Construct/Copy/Destroy
+    explicit split_map_adapter(const key_compare &cmp = key_compare())
+     : comparator(cmp) {}
+    template <class InputIterator>
+    split_map_adapter(InputIterator b, InputIterator e,
+                      const key_compare &cmp = key_compare())
+     : comparator(cmp) {
+        for ( ; b != e; ++b ) {
+            kc.push_back(b->first);
+            mc.push_back(b->second);
+        }
+        detail::sort_split(kc, mc, comparator, true);
+    }
+    template <class InputIterator>
+    split_map_adapter(sorted_unique_t, InputIterator b, InputIterator e,
+                      const key_compare &cmp = key_compare())
+     : comparator(cmp) {
+        for ( ; b != e; ++b ) {
+            kc.push_back(b->first);
+            mc.push_back(b->second);
+        }
+        assert( ordered() );
+    }
+    // default copy ctr
+    // default destructor
+    // default assignment
+    // Extra
+    // keys[i] maps to values[i]; the sizes must match
+    split_map_adapter(key_container const &keys,
+                      mapped_container const &values,
+                      const key_compare &cmp = key_compare())
+     : kc(keys), mc(values), comparator(cmp) {
+        assert( kc.size() == mc.size() );
+        detail::sort_split(kc, mc, comparator, true);
+    }
+    split_map_adapter(sorted_unique_t, key_container const &keys,
+                      mapped_container const &values,
+                      const key_compare &cmp = key_compare())
+     : kc(keys), mc(values), comparator(cmp) {
+        assert( kc.size() == mc.size() );
+        assert( ordered() );
+    }
+#ifdef ASSIST_HAS_CXX11
+    split_map_adapter(sorted_unique_t, key_container &&keys,
+                      mapped_container &&values,
+                      const key_compare &cmp = key_compare())
+     : kc(std::move(keys)), mc(std::move(values)), comparator(cmp) {
+        assert( kc.size() == mc.size() );
+        assert( ordered() );
+    }
+#endif
+
+    key_container const &keys() const { return kc; }
+    mapped_container const &values() const { return mc; }
+
+    // Iterators
+    iterator begin() { return iterator(kc.begin(), mc.begin()); }
+    const_iterator begin() const { return const_iterator(kc.begin(), mc.begin()); }
+    iterator end() { return iterator(kc.end(), mc.end()); }
+    const_iterator end() const { return const_iterator(kc.end(), mc.end()); }
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    // Capacity
+    bool empty() const { return kc.empty(); }
+    size_type size() const { return kc.size(); }
+    size_type max_size() const { return kc.max_size(); }
+    // Extra
+    size_type capacity() const { return kc.capacity(); }
+    void reserve(size_type n) {
+        kc.reserve(n);
+        mc.reserve(n);
+    }
+
+    // Modifiers
+    std::pair<iterator, bool> insert(const value_type &v) {
+        return insert_at(search::lower_bound(kc.begin(), kc.end(),
+                                             v.first, comparator), v);
+    }
+    iterator insert(const_iterator hint, const value_type &v) {
+        return insert_at(locate(hint, v.first), v).first;
+    }
+    // The batch is appended, sorted, and merged in, in one pass;
+    // O(m log m + n), where inserting one at a time would be O(m n)
+    template <class InputIterator>
+    void insert(InputIterator b, InputIterator const e) {
+        size_type const before_size = size();
+        try {
+            for ( ; b != e; ++b ) {
+                kc.push_back(b->first);
+                mc.push_back(b->second);
+            }
+        } catch (...) {
+            kc.erase(kc.begin()+before_size, kc.end());
+            mc.erase(mc.begin()+before_size, mc.end());
+            throw;
+        }
+        // a key repeated in the batch keeps its first value, and a key
+        // already present keeps the value it has
+        detail::sort_split(kc, mc, comparator, true, before_size);
+        detail::merge_split(kc, mc, before_size, comparator, true);
+    }
+#ifdef ASSIST_HAS_CXX11
+    // The mapped value is only constructed if k is not already present
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(const key_type &k, Args &&...args) {
+        key_iterator const it = search::lower_bound(kc.begin(), kc.end(),
+                                                    k, comparator);
+        if ( it != kc.end() && !comparator(k, *it) ) {
+            return std::make_pair(at(it), false);
+        }
+        return std::make_pair(emplace_at(it, k, std::forward<Args>(args)...),
+                              true);
+    }
+    template <class M>
+    std::pair<iterator, bool> insert_or_assign(const key_type &k, M &&m) {
+        key_iterator const it = search::lower_bound(kc.begin(), kc.end(),
+                                                    k, comparator);
+        if ( it != kc.end() && !comparator(k, *it) ) {
+            mc[it - kc.begin()] = std::forward<M>(m);
+            return std::make_pair(at(it), false);
+        }
+        return std::make_pair(emplace_at(it, k, std::forward<M>(m)), true);
+    }
+#endif
+    void erase(const_iterator it) {
+        difference_type const i = it - begin();
+        kc.erase(kc.begin()+i);
+        mc.erase(mc.begin()+i);
+    }
+    void erase(const_iterator b, const_iterator e) {
+        difference_type const i = b - begin(), j = e - begin();
+        kc.erase(kc.begin()+i, kc.begin()+j);
+        mc.erase(mc.begin()+i, mc.begin()+j);
+    }
+    size_type erase(const key_type &k) {
+        std::pair<iterator, iterator> r = equal_range(k);
+        size_type const n = r.second - r.first;
+        erase(r.first, r.second);
+        return n;
+    }
+    void swap(split_map_adapter &other) {
+        // swap comparator first for exception safety
+        std::swap( comparator, other.comparator );
+        kc.swap(other.kc);
+        mc.swap(other.mc);
+    }
+    void clear() {
+        kc.clear();
+        mc.clear();
+    }
+
+    // Observers
+    key_compare key_comp() const { return comparator; }
+    value_compare value_comp() const { return value_compare(comparator); }
+
+    // map operations
+    mapped_type &operator[](const key_type &k) {
+        key_iterator it = search::lower_bound(kc.begin(), kc.end(),
+                                              k, comparator);
+        if ( it == kc.end() || comparator(k, *it) ) {
+            it = insert_at(it, value_type(k, mapped_type())).first
+                     .key_iterator();
+        }
+        return mc[it - kc.begin()];
+    }
+
+    // Set operations
+    size_type count(const key_type &k) const {
+        return search::binary_search(kc.begin(), kc.end(), k, comparator);
+    }
+    std::pair<iterator, iterator> equal_range(const key_type &k) {
+        std::pair<key_iterator, key_iterator> r =
+            search::equal_range(kc.begin(), kc.end(), k, comparator);
+        return std::make_pair(at(r.first), at(r.second));
+    }
+    std::pair<const_iterator, const_iterator> equal_range(const key_type &k) const {
+        std::pair<key_iterator, key_iterator> r =
+            search::equal_range(kc.begin(), kc.end(), k, comparator);
+        return std::make_pair(at(r.first), at(r.second));
+    }
+    iterator find(const key_type &k) {
+        key_iterator const it = search::lower_bound(kc.begin(), kc.end(),
+                                                    k, comparator);
+        if ( it == kc.end() || comparator(k, *it) ) return end();
+        return at(it);
+    }
+    const_iterator find(const key_type &k) const {
+        key_iterator const it = search::lower_bound(kc.begin(), kc.end(),
+                                                    k, comparator);
+        if ( it == kc.end() || comparator(k, *it) ) return end();
+        return at(it);
+    }
+    iterator lower_bound(const key_type &k) {
+        return at(search::lower_bound(kc.begin(), kc.end(), k, comparator));
+    }
+    const_iterator lower_bound(const key_type &k) const {
+        return at(search::lower_bound(kc.begin(), kc.end(), k, comparator));
+    }
+    iterator upper_bound(const key_type &k) {
+        return at(search::upper_bound(kc.begin(), kc.end(), k, comparator));
+    }
+    const_iterator upper_bound(const key_type &k) const {
+        return at(search::upper_bound(kc.begin(), kc.end(), k, comparator));
+    }
+    bool contains(const key_type &k) const {
+        return search::binary_search(kc.begin(), kc.end(), k, comparator);
+    }
+
+    // Comparison Operators
+    bool operator==(split_map_adapter const &other) const {
+        return kc == other.kc && mc == other.mc;
+    }
+    bool operator!=(split_map_adapter const &other) const {
+        return !(*this == other);
+    }
+    bool operator<(split_map_adapter const &other) const {
+        return std::lexicographical_compare(begin(), end(),
+                                            other.begin(), other.end());
+    }
+    bool operator<=(split_map_adapter const &other) const {
+        return !(other < *this);
+    }
+    bool operator>(split_map_adapter const &other) const {
+        return other < *this;
+    }
+    bool operator>=(split_map_adapter const &other) const {
+        return !(*this < other);
+    }
+};
+
+namespace detail {
+template < typename key_container, typename mapped_container, typename CMP >
+struct is_unique_adapter<
+    split_map_adapter<key_container, mapped_container, CMP> > {
+    static bool const value = true;
+};
+} // namespace detail
+
+// Overloaded Algorithms
+template < typename key_container, typename mapped_container,
+            typename CMP >
+void swap(split_map_adapter<key_container, mapped_container, CMP> &lhs,
+          split_map_adapter<key_container, mapped_container, CMP> &rhs) {
+    lhs.swap(rhs);
+}
+
+} // namespace assist
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef ASSIST_STATS_HPP
+#define ASSIST_STATS_HPP
+
+/*
+ * assist/stats.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* Statistics policies, the last template parameter of the sorted
+ * adapters.  The default, no_stats, compiles away entirely: the adapter
+ * is the same size and runs the same code as without it.  adapter_stats
+ * counts the work done, to be exported or checked for pathological use:
+ *
+ *     typedef std::vector<int> base;
+ *     set_adapter< base, std::less<int>, adapter_stats > s;
+ *     ...
+ *     if ( s.stats().sorts > 1 ) log("re-sorted behind our back");
+ *
+ * The counts are of
+ *  - comparisons, including the check that assigned or swapped-in
+ *    contents are already in order;
+ *  - elements moved along by insert and erase to open or close a gap,
+ *    and elements merged in by a range insert;
+ *  - reallocations of the base_type, which must have capacity();
+ *  - sorts, from the constructors, operator=(base_type) and
+ *    swap(base_type) as well as a range insert, when the input turns
+ *    out not to be in order, and merges;
+ *  - lookups, and the comparisons each one took (its probe depth).
+ *
+ * Counting comparisons means searching through a wrapped comparator,
+ * so integer keys lose the vectorised search, and the counters aren't
+ * shared between threads: the threads of a parallel_t sort don't count
+ * their comparisons.  A const lookup still counts, so an adapter with
+ * statistics can't be read from several threads at once.
+ *
+ * A policy of one's own needs the same hooks as adapter_stats.
+ */
+
+#include <cstddef> // size_t
+
+namespace assist {
+
+// Counts nothing, at no cost
+struct no_stats {
+    void on_compare() {}
+    void on_move(std::size_t) {}
+    void on_reallocate() {}
+    void on_sort() {}
+    void on_merge() {}
+    void on_lookup(std::size_t) {}
+    std::size_t compare_count() const { return 0; }
+};
+
+struct adapter_stats {
+    std::size_t comparisons;
+    std::size_t moves;
+    std::size_t reallocations;
+    std::size_t sorts;
+    std::size_t merges;
+    std::size_t lookups;
+    // summed over the lookups, and the deepest of them
+    std::size_t probes;
+    std::size_t max_probes;
+
+    adapter_stats() { reset(); }
+    void reset() {
+        comparisons = moves = reallocations = 0;
+        sorts = merges = 0;
+        lookups = probes = max_probes = 0;
+    }
+
+    // Hooks
+    void on_compare() { ++comparisons; }
+    void on_move(std::size_t n) { moves += n; }
+    void on_reallocate() { ++reallocations; }
+    void on_sort() { ++sorts; }
+    void on_merge() { ++merges; }
+    void on_lookup(std::size_t depth) {
+        ++lookups;
+        probes += depth;
+        if ( depth > max_probes ) max_probes = depth;
+    }
+    // What on_lookup's depth is measured from
+    std::size_t compare_count() const { return comparisons; }
+};
+
+} // namespace assist
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef ASSIST_TAGS_HPP
+#define ASSIST_TAGS_HPP
+
+/*
+ * assist/tags.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* Tags selecting alternative constructors and bulk modifiers
+ * of the sorted adapters.
+ */
+
+namespace assist {
+
+// Sort (and merge) on several threads.  threads == 0 means one per
+// hardware thread; small inputs, and builds without ASSIST_HAS_THREADS,
+// quietly use the serial code.
+struct parallel_t {
+    unsigned threads;
+    explicit parallel_t(unsigned n = 0) : threads(n) {}
+};
+parallel_t const parallel = parallel_t();
+
+// The input is already in order, so it's taken as it is, without the
+// sort.  sorted_unique (for the set_adapter and map_adapter) promises
+// no two elements are equivalent; sorted_equivalent (for the multi
+// adapters) allows equivalent neighbours.  Debug builds assert it.
+struct sorted_unique_t {
+    sorted_unique_t() {}
+};
+sorted_unique_t const sorted_unique = sorted_unique_t();
+struct sorted_equivalent_t {
+    sorted_equivalent_t() {}
+};
+sorted_equivalent_t const sorted_equivalent = sorted_equivalent_t();
+
+} // namespace assist
+
+#endif
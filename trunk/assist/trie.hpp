@@ -1,5 +1,5 @@
 #ifndef ASSIST_TRIE_HPP
-#define ASSIST_TRIE_ADAPTER_HPP
+#define ASSIST_TRIE_HPP
 
 /*
  * assist/trie.hpp
@@ -11,376 +11,633 @@
  *
  */
 
-#include <cstddef>
-#include <limits>
-#include <climits>
-#include <cassert>
+/* A map from byte-string keys, kept as an adaptive radix tree rather
+ * than sorted: a lookup reads each byte of the key once, and doesn't
+ * compare whole keys until it reaches a leaf, so it costs O(key length)
+ * however many keys there are.
+ *
+ *     trie<std::string, route> routes;
+ *     routes["/api/users"] = users;
+ *     trie<std::string, route>::const_iterator it = routes.find(path);
+ *
+ * Integer keys work too, a byte at a time from the most significant,
+ * so they iterate in numeric order and a lookup takes at most
+ * sizeof(Key) steps: an ordered map that, unlike a sorted vector,
+ * doesn't move anything to insert.
+ *
+ * The keys starting with any one prefix share a subtree, so finding
+ * them with prefix_range, or the longest_prefix_match of a key (for
+ * routing tables), takes one walk down like find's.
+ *
+ * Iteration is in key order.  Iterators are forward only, and carry
+ * the path to their leaf with them, so they're a little heavier than
+ * usual to copy.  Inserting and erasing invalidate them, but references
+ * to the elements stay valid until they're erased.
+ *
+ * The nodes live in pools, a few per trie, rather than each on the heap
+ * by itself, and name each other by 32-bit indices, so a key costs
+ * about its element plus a few bytes, and copying or clearing a trie
+ * works a chunk of nodes at a time.  Erased nodes' slots are reused but
+ * the pools only shrink on clear().
+ *
+ * See detail/trie_node.hpp for the layout of the nodes.
+ */
 
-#include <boost/static_assert.hpp>
-#include <boost/mpl/if.hpp>
+#include <utility> // pair
+#include <algorithm> // equal, min, swap
+#include <stdexcept> // out_of_range
+#include <new> // bad_alloc
+#include <cstddef> // size_t, ptrdiff_t
+#include <climits> // CHAR_BIT, UCHAR_MAX
+
+#include "detail/config.hpp"
+#include "detail/trie_node.hpp"
 
 namespace assist {
 
+// How trie reads a key as a string of bytes.  Keys must order as those
+// strings do, compared as unsigned char, which is how std::string and
+// the other sequences of bytes this handles compare.
 template <typename T>
 struct trie_traits {
-    typedef typename T::value_type value_type;
-    typedef typename T::const_reference const_reference;
-    typedef typename T::size_type size_type;
-    template <typename mapped_type>
-    struct map {
-        typedef std::map< value_type, mapped_type > type;
-    };
-    size_type max_size(T const &c) const { return c.max_size(); }
-    size_type size(T const &c) const { return c.size(); }
-    const_reference get(T const &c, size_type i) const { return c[i]; }
+    typedef std::size_t size_type;
+    size_type size(T const &k) const { return k.size(); }
+    unsigned char get(T const &k, size_type i) const {
+        return static_cast<unsigned char>(k[i]);
+    }
 };
-/*
-#define ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION(T) \
-template <> \
-struct trie_traits { \
-    typedef unsigned char value_type; \
-    typedef value_type const_reference; \
-    typedef std::size_t size_type; \
-    size_type max_size(T) const { return sizeof(T); } \
-    size_type size(T) const { return sizeof(T); } \
-    const_reference get(T v, size_t i) const { \
-        return ( v >> i*CHAR_BIT ) & UCHAR_MAX; \
-    } \
-}
-ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION(           char );
-ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION( unsigned char );
-ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION(   signed char );
-ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION( unsigned short );
-ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION(   signed short );
-ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION( unsigned int );
-ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION(   signed int );
-ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION( unsigned long );
-ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION(   signed long );
-*/
 
-template < typename Map_type, typename Data_type >
-class trie {
-    Map_type _map;
-    trie *parent;
-    Data_type _data;
-
-  public:
-    typedef typename Map_type map_type;
-    typedef typename map_type::key_type key_type;
-    typedef Data_type mapped_type;
+// Integers read most significant byte first, with the sign bit of the
+// signed ones flipped, so that the byte strings order as the numbers do
+template < typename T >
+struct integer_trie_traits {
+    typedef std::size_t size_type;
+    size_type size(T) const { return sizeof(T); }
+    unsigned char get(T v, size_type i) const {
+        // a negative v sign-extends, but only its own bytes are read
+        typedef unsigned long long bits;
+        bits const top = bits(1) << ( sizeof(T)*CHAR_BIT - 1 );
+        bits const u = bits(v) ^ ( T(-1) < T(0) ? top : 0 );
+        return static_cast<unsigned char>(
+                   ( u >> ( sizeof(T)-1-i )*CHAR_BIT ) & UCHAR_MAX );
+    }
 };
+#define ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION(T) \
+template <> \
+struct trie_traits<T> : integer_trie_traits<T> {}
+ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION(              char );
+ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION(     unsigned char );
+ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION(       signed char );
+ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION(    unsigned short );
+ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION(      signed short );
+ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION(      unsigned int );
+ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION(        signed int );
+ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION(     unsigned long );
+ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION(       signed long );
+ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION( unsigned long long );
+ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION(   signed long long );
+#undef ASSIST_DETAIL_DEFINE_TRIE_TRAITS_SPECIALISATION
 
-template < typename T, typename Traits = trie_traits<T> >
+template < typename Key, typename T, typename Traits = trie_traits<Key> >
 class trie {
-    typename Traits::map<trie*>::type c;
-    bool is_path_end;
-
   public:
     // Types
-    typedef typename Traits::map_type map_type;
-    typedef typename map_type::value_type ;
-    typedef typename map_type::key_type key_type;
+    typedef Key key_type;
     typedef T mapped_type;
-    typedef typename map_type::key_compare key_compare;
-    typedef typename map_type::value_compare value_compare;
+    typedef std::pair<Key const, T> value_type;
+    typedef Traits traits_type;
+    typedef value_type &reference;
+    typedef value_type const &const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef value_type *pointer;
+    typedef value_type const *const_pointer;
+    typedef detail::trie_iterator<value_type, reference, pointer> iterator;
+    typedef detail::trie_iterator<value_type, const_reference,
+                                  const_pointer> const_iterator;
 
-    typedef typename map_type::allocator_type allocator_type;
-/*
-    typedef typename map_type::reference reference;
-    typedef typename map_type::const_reference const_reference;
-    typedef typename map_type::size_type size_type;
-    typedef typename map_type::difference_type difference_type;
-    typedef typename map_type::pointer pointer;
-    typedef typename map_type::const_pointer const_pointer;
-    typedef typename map_type::iterator iterator;
-    typedef typename map_type::const_iterator const_iterator;
-    typedef typename map_type::reverse_iterator reverse_iterator;
-    typedef typename map_type::const_reverse_iterator const_reverse_iterator;
-*/
-//    typedef typename map_type:: ;
+  private:
+    typedef detail::trie_ref ref;
+    typedef detail::trie_inner inner;
+    typedef detail::trie_nodes<value_type> nodes_type;
 
-    // Construct/Copy/Destroy
-    explicit set_adapter(const key_compare &cmp = key_compare(), 
-                          const allocator_type &alloc = allocator_type ())
-     : c(alloc), comparator(cmp) {}
-    template <class InputIterator>
-    set_adapter(InputIterator b, InputIterator e, 
-                const key_compare &cmp = key_compare(), 
-                const allocator_type &alloc = allocator_type ())
-     : c(b, e, alloc), comparator(cmp) {
-        std::sort(begin(), end(), comparator);
-        c.erase(std::unique(begin(), end(), not2(comparator)), end());
-    }
-    // default copy ctr
-    // default destructor
-    // default assignment
-    // Extra
-    explicit set_adapter(base_type const &b,
-                          const key_compare &cmp = key_compare())
-     : c(b), comparator(cmp) {
-        std::sort(begin(), end(), comparator);
-        c.erase(std::unique(begin(), end(), not2(comparator)), end());
-    }
-    set_adapter &operator=(base_type const &b) {
-        c = b;
-        std::sort(begin(), end(), comparator);
-        c.erase(std::unique(begin(), end(), not2(comparator)), end());
-        return *this;
-    }
+    // Allocated with the first element, so that swapping and moving
+    // leave iterators pointing at the right pools
+    nodes_type *nodes;
+    ref root;
+    size_type items;
+    Traits key_traits;
 
-    base_type const &base() const { return c; }
-
-    // Iterators
-    iterator begin() { return c.begin(); }
-    const_iterator begin() const { return c.begin(); }
-    iterator end() { return c.end(); }
-    const_iterator end() const { return c.end(); }
-    reverse_iterator rbegin() { return c.rbegin(); }
-    const_reverse_iterator rbegin() const { return c.rbegin(); }
-    reverse_iterator rend() { return c.rend(); }
-    const_reverse_iterator rend() const { return c.rend(); }
-  
-    // Capacity
-    bool empty() const { return c.empty(); }
-    size_type size() const { return c.size(); }
-    size_type max_size() const { return c.max_size(); }
-    // Extra
-    size_type capacity() const { return c.capacity(); }
-    void reserve(size_type n) { return c.reserve(n); }
-
-    // Modifiers
-    std::pair<iterator, bool> insert(const value_type &v) {
-        if ( empty() ) {
-            c.push_back(v);
-            return std::make_pair( begin(), true );
+    value_type *leaf(ref l) const { return nodes->leaf(l); }
+    key_type const &key_of(ref l) const { return leaf(l)->first; }
+    inner *inner_of(ref n) const { return nodes->inner(n); }
+    bool same_key(key_type const &a, key_type const &b) const {
+        size_type const n = key_traits.size(a);
+        if ( n != key_traits.size(b) ) return false;
+        for ( size_type i = 0; i != n; ++i ) {
+            if ( key_traits.get(a, i) != key_traits.get(b, i) ) return false;
         }
-        iterator it = lower_bound(v);
-        if ( it == end() || comparator(v, *it) ) {
-            it = c.insert(it, v);
-            return std::make_pair(it, true);
-        } else {
-            return std::make_pair(it, false);
+        return true;
+    }
+    void set_prefix(inner *p, key_type const &k, size_type depth,
+                    size_type len) {
+        p->prefix_len = static_cast<unsigned int>(len);
+        size_type const stored = std::min(len, detail::trie_prefix_bytes);
+        for ( size_type i = 0; i != stored; ++i ) {
+            p->prefix[i] = key_traits.get(k, depth+i);
         }
     }
-    iterator insert(iterator hint, const value_type &v) {
-        if ( empty() ) {
-            c.push_back(v);
-            return begin();
+    // Whether k, from depth on, might go through p, going by the
+    // prefix bytes p keeps; a leaf's key settles it
+    bool may_match_prefix(inner const *p, key_type const &k,
+                          size_type depth) const {
+        if ( key_traits.size(k) - depth < p->prefix_len ) return false;
+        size_type const stored = std::min<size_type>(p->prefix_len,
+                                                     detail::trie_prefix_bytes);
+        for ( size_type i = 0; i != stored; ++i ) {
+            if ( p->prefix[i] != key_traits.get(k, depth+i) ) return false;
         }
-        if ( hint == begin() ) {
-            if ( comparator(v,*begin()) ) {
-                c.insert(hint,v);
-                return begin();
-            }
-            ++hint;
+        return true;
+    }
+    // How many of p's prefix bytes k matches from depth on
+    size_type match_prefix(inner const *p, key_type const &k,
+                           size_type depth) const {
+        size_type const stop = std::min<size_type>(p->prefix_len,
+                                                   key_traits.size(k) - depth);
+        size_type const stored = std::min(stop, detail::trie_prefix_bytes);
+        size_type i = 0;
+        for ( ; i != stored; ++i ) {
+            if ( p->prefix[i] != key_traits.get(k, depth+i) ) return i;
         }
-        if ( hint == end() ) {
-            if ( comparator(*rbegin(),v) ) {
-                c.push_back(v);
-                return end()-1;
+        if ( i == stop ) return i;
+        key_type const &full = key_of(nodes->min_leaf(p));
+        for ( ; i != stop; ++i ) {
+            if ( key_traits.get(full, depth+i) != key_traits.get(k, depth+i) ) {
+                return i;
             }
-            --hint;
         }
-/*
-        iterator b = begin(), e = end();
-*/
-        iterator b = hint, e = hint;
-        for ( difference_type i = 0; ; i = (i<<1)|1 ) {
-            if ( i >= hint-begin() ) {
-                b = begin();
-                break;
+        return i;
+    }
+
+    // The leaf with key k, or 0; with path, records the way down
+    ref lookup(key_type const &k, detail::trie_path *path) const {
+        size_type const size = key_traits.size(k);
+        ref n = root;
+        size_type depth = 0;
+        while ( n && !detail::is_trie_leaf(n) ) {
+            inner const *const p = inner_of(n);
+            if ( !may_match_prefix(p, k, depth) ) return 0;
+            depth += p->prefix_len;
+            int pos = detail::trie_frame::at_value;
+            if ( depth == size ) {
+                n = p->value;
+            } else {
+                pos = detail::find_child(p, key_traits.get(k, depth++));
+                if ( pos < 0 ) return 0;
+                n = detail::child_at(p, pos);
+            }
+            if ( path ) {
+                detail::trie_frame const f = { p, pos };
+                path->push_back(f);
             }
-            b -= i;
-            if ( comparator(*b,v) ) break;
         }
-        for ( difference_type i = 0; ; i = (i<<1)|1 ) {
-            if ( i >= end()-e ) {
-                e = end();
+        return n && same_key(key_of(n), k) ? n : 0;
+    }
+
+    // The longest key that's a prefix of k, with the way down to it
+    ref longest_prefix(key_type const &k, detail::trie_path &path) const {
+        size_type const size = key_traits.size(k);
+        ref n = root;
+        size_type depth = 0;
+        ref best = 0;
+        size_type best_frames = 0;
+        bool best_is_value = false;
+        while ( n ) {
+            if ( detail::is_trie_leaf(n) ) {
+                // the bytes before depth have all been matched
+                key_type const &l = key_of(n);
+                size_type const lsize = key_traits.size(l);
+                size_type i = depth;
+                if ( lsize > size ) break;
+                while ( i != lsize && key_traits.get(l, i) == key_traits.get(k, i) ) ++i;
+                if ( i == lsize ) {
+                    best = n;
+                    best_frames = path.size();
+                    best_is_value = false;
+                }
                 break;
             }
-            e += i;
-            if ( comparator(v,*b) ) break;
-        }
-        while ( b != e ) {
-            if ( comparator(v,*hint) ) {
-                e = hint;
-            } else if ( comparator(*hint,v) ) {
-                b = hint+1;
-            } else {
-                // equivalent to *hint
-                return hint;            
+            inner const *const p = inner_of(n);
+            if ( match_prefix(p, k, depth) != p->prefix_len ) break;
+            depth += p->prefix_len;
+            detail::trie_frame const f = { p, detail::trie_frame::at_value };
+            path.push_back(f);
+            if ( p->value ) {
+                best = p->value;
+                best_frames = path.size();
+                best_is_value = true;
             }
-            hint = b + (e-b)/2;
+            if ( depth == size ) break;
+            int const pos = detail::find_child(p, key_traits.get(k, depth++));
+            if ( pos < 0 ) break;
+            path.back().pos = pos;
+            n = detail::child_at(p, pos);
+        }
+        if ( best ) {
+            path.resize(best_frames);
+            if ( best_is_value ) path.back().pos = detail::trie_frame::at_value;
         }
-        return c.insert(hint,v);
+        return best;
     }
-/*
-    iterator insert(iterator hint, const value_type &v) {
-    ******FIX******
-        if ( hint >= end()-1 ) {
-            if ( empty() || comparator(*(end()-1), v) ) {
-                c.push_back(v);
-                return end()-1;
-            } else {
-                return insert(v).first;
+    // The node holding every key that starts with prefix, or 0, with the
+    // way down to it
+    ref prefix_root(key_type const &prefix, detail::trie_path &path) const {
+        size_type const size = key_traits.size(prefix);
+        ref n = root;
+        size_type depth = 0;
+        while ( n && !detail::is_trie_leaf(n) ) {
+            inner const *const p = inner_of(n);
+            size_type const matched = match_prefix(p, prefix, depth);
+            if ( depth + matched == size ) return n;
+            if ( matched != p->prefix_len ) return 0;
+            depth += p->prefix_len;
+            int const pos = detail::find_child(p, key_traits.get(prefix, depth++));
+            if ( pos < 0 ) return 0;
+            detail::trie_frame const f = { p, pos };
+            path.push_back(f);
+            n = detail::child_at(p, pos);
+        }
+        if ( !n ) return 0;
+        // a lone leaf: it has to start with the whole of prefix
+        key_type const &l = key_of(n);
+        if ( key_traits.size(l) < size ) return 0;
+        for ( ; depth != size; ++depth ) {
+            if ( key_traits.get(l, depth) != key_traits.get(prefix, depth) ) return 0;
+        }
+        return n;
+    }
+
+    // Puts l, with key k, under p, which branches at depth
+    void hang(inner *p, ref l, key_type const &k, size_type depth) {
+        if ( key_traits.size(k) == depth ) {
+            p->value = l;
+        } else {
+            detail::add_child(p, key_traits.get(k, depth), l);
+        }
+    }
+    // A leaf holding v, and a node4 to hang it from; if the node can't
+    // be had, neither can the leaf
+    ref new_leaf_and_node4(value_type const &v, ref &l) {
+        l = nodes->new_leaf(v);
+        try {
+            return nodes->new_inner(detail::trie_node4_kind);
+        } catch (...) {
+            nodes->delete_leaf(l);
+            throw;
+        }
+    }
+    // The leaf with v's key, and whether it's a new one holding v
+    std::pair<ref, bool> insert_leaf(value_type const &v) {
+        if ( !nodes ) nodes = new nodes_type;
+        key_type const &k = v.first;
+        size_type const size = key_traits.size(k);
+        // the ref to what's next, in the node above it (or root)
+        ref *slot = &root;
+        size_type depth = 0;
+        for ( ;; ) {
+            ref const n = *slot;
+            if ( !n ) {
+                *slot = nodes->new_leaf(v);
+                ++items;
+                return std::make_pair(*slot, true);
+            }
+            if ( detail::is_trie_leaf(n) ) {
+                key_type const &other = key_of(n);
+                if ( same_key(other, k) ) return std::make_pair(n, false);
+                // Both go under a new node, past the bytes they share
+                size_type const stop = std::min(size, key_traits.size(other));
+                size_type common = depth;
+                while ( common != stop &&
+                        key_traits.get(k, common) == key_traits.get(other, common) ) {
+                    ++common;
+                }
+                ref l;
+                ref const r = new_leaf_and_node4(v, l);
+                inner *const p = inner_of(r);
+                set_prefix(p, k, depth, common-depth);
+                hang(p, n, other, common);
+                hang(p, l, k, common);
+                *slot = r;
+                ++items;
+                return std::make_pair(l, true);
+            }
+            inner *p = inner_of(n);
+            size_type const matched = match_prefix(p, k, depth);
+            if ( matched != p->prefix_len ) {
+                // k leaves p's prefix partway, so split it there
+                key_type const &below = key_of(nodes->min_leaf(p));
+                ref l;
+                ref const r = new_leaf_and_node4(v, l);
+                inner *const q = inner_of(r);
+                set_prefix(q, k, depth, matched);
+                detail::add_child(q, key_traits.get(below, depth+matched), n);
+                set_prefix(p, below, depth+matched+1,
+                           p->prefix_len-matched-1);
+                hang(q, l, k, depth+matched);
+                *slot = r;
+                ++items;
+                return std::make_pair(l, true);
             }
+            depth += p->prefix_len;
+            if ( depth == size ) {
+                if ( p->value ) return std::make_pair(p->value, false);
+                p->value = nodes->new_leaf(v);
+                ++items;
+                return std::make_pair(p->value, true);
+            }
+            unsigned char const b = key_traits.get(k, depth);
+            int const pos = detail::find_child(p, b);
+            if ( pos >= 0 ) {
+                slot = &detail::child_at(p, pos);
+                ++depth;
+                continue;
+            }
+            ref const l = nodes->new_leaf(v);
+            if ( detail::is_full(p) ) {
+                try {
+                    *slot = nodes->grow(n);
+                } catch (...) {
+                    nodes->delete_leaf(l);
+                    throw;
+                }
+                p = inner_of(*slot);
+            }
+            detail::add_child(p, b, l);
+            ++items;
+            return std::make_pair(l, true);
         }
-        if ( comparator( *hint, v ) ) {
-            if ( comparator( v, *(hint+1) ) ) {
-                // right place
-                return c.insert(hint, v);       
-            } else {
-                // *hint equivalent to v
-                // nothing to do
-                return hint;
+    }
+
+    // Tidies the node at *slot, which starts at depth, after one of
+    // its leaves was erased.  Every inner node keeps at least two
+    // entries, counting its value, so it's left with at least one.
+    void collapse(ref *slot, size_type depth) {
+        ref const n = *slot;
+        inner *const p = inner_of(n);
+        if ( p->count == 0 ) {
+            *slot = p->value;
+            nodes->delete_inner(n);
+            return;
+        }
+        if ( p->count == 1 && !p->value ) {
+            ref const child = detail::child_at(p, detail::next_child(p, 0));
+            if ( !detail::is_trie_leaf(child) ) {
+                // its prefix takes in p's, and the byte between
+                inner *const c = inner_of(child);
+                set_prefix(c, key_of(nodes->min_leaf(c)), depth,
+                           p->prefix_len + 1 + c->prefix_len);
             }
-        } else {
-            // hint was wrong
-            return insert(v).first;
+            *slot = child;
+            nodes->delete_inner(n);
+            return;
         }
+        try {
+            *slot = nodes->shrink(n);
+        } catch (std::bad_alloc const &) {
+            // p is still good, if roomier than it needs to be
+        }
+    }
+
+    void destroy() {
+        if ( !nodes ) return;
+        nodes->clear(root, items);
+        delete nodes;
     }
-*/
+
+  public:
+    // Construct/Copy/Destroy
+    explicit trie(traits_type const &t = traits_type())
+     : nodes(0), root(0), items(0), key_traits(t) {}
     template <class InputIterator>
-    void insert(InputIterator b, InputIterator const e) {
-    /*
-        // Simple, obvious, but often slow
-        // basic exception safe.
-        while (b != e) insert(*b++);
-    */
-        // More complex, but likely faster.
-        // *Not* safe if the comparator throws, though :|
-        size_type const before_size = size();
+    trie(InputIterator b, InputIterator e,
+         traits_type const &t = traits_type())
+     : nodes(0), root(0), items(0), key_traits(t) {
         try {
-            c.insert(c.end(), b, e);
+            insert(b, e);
         } catch (...) {
-            assert( size() >= before_size );
-            if ( size() != before_size ) c.resize(before_size);
+            destroy();
             throw;
         }
-        std::sort(begin()+before_size, end(), comparator);
-        std::inplace_merge(begin(), begin()+before_size, end(), comparator);
-        c.erase(std::unique(begin(), end(), not2(comparator)), end());
-    }
-    void erase(iterator it) { c.erase(it); }
-    size_type erase(const key_type &k) { c.erase(find(k)); }
-    void erase(iterator b, iterator e) { c.erase(b, e); }
-    void swap(set_adapter &other) {
-        using namespace std;
-        // swap comparator first for exception safety
-        swap( comparator, other.comparator );
-        c.swap(other.c); // swap( c, other.c );
-    }
-    void clear() { c.clear(); }
-    // Extra
-    // useful for building a base_type unsorted, then swapping it in
-    void swap(base_type &other) {
-        using namespace std;
-        c.swap(other); // swap( c, other.c );
-        std::sort(begin(), end(), comparator);
-        c.erase(std::unique(begin(), end(), not2(comparator)), end());
     }
+    // The nodes are copied a pool at a time, into the same slots
+    trie(trie const &other)
+     : nodes(0), root(other.root), items(other.items),
+       key_traits(other.key_traits) {
+        if ( !other.nodes ) return;
+        nodes = new nodes_type;
+        try {
+            nodes->assign(*other.nodes, root);
+        } catch (...) {
+            delete nodes;
+            throw;
+        }
+    }
+    trie &operator=(trie const &other) {
+        trie(other).swap(*this);
+        return *this;
+    }
+#ifdef ASSIST_HAS_CXX11
+    trie(trie &&other)
+     : nodes(other.nodes), root(other.root), items(other.items),
+       key_traits(other.key_traits) {
+        other.nodes = 0;
+        other.root = 0;
+        other.items = 0;
+    }
+    trie &operator=(trie &&other) {
+        trie(std::move(other)).swap(*this);
+        return *this;
+    }
+#endif
+    ~trie() { destroy(); }
 
-    // Observers
-    key_compare key_comp() const { return comparator; }
-    value_compare value_comp() const { return key_comp(); }
+    // Iterators
+    iterator begin() { return iterator(nodes, root); }
+    const_iterator begin() const { return const_iterator(nodes, root); }
+    iterator end() { return iterator(); }
+    const_iterator end() const { return const_iterator(); }
 
-    // Set operations
-    size_type count(const key_type &k) const {
-        return contains(k)?1:0;
+    // Capacity
+    bool empty() const { return items == 0; }
+    size_type size() const { return items; }
+    size_type max_size() const {
+        return std::min<size_type>(detail::trie_max_nodes,
+                                   size_type(-1) / sizeof(value_type));
     }
-    std::pair<iterator, iterator> equal_range(const key_type &k) {
-        return std::equal_range(begin(), end(), k, value_comp());
+
+    // Element Access
+    mapped_type &operator[](key_type const &k) {
+        ref const l = lookup(k, 0);
+        if ( l ) return leaf(l)->second;
+        return leaf(insert_leaf(value_type(k, mapped_type())).first)->second;
     }
-    std::pair<const_iterator, const_iterator> equal_range(const key_type &k) const {
-        return std::equal_range(begin(), end(), k, value_comp());
+    mapped_type &at(key_type const &k) {
+        ref const l = lookup(k, 0);
+        if ( !l ) throw std::out_of_range("assist: trie::at");
+        return leaf(l)->second;
     }
-    iterator find(const key_type &k) {
-        iterator it = lower_bound(k);
-        if ( it == end() || comparator(k, *it) ) {
-            return end();
-        } else {
-            return it;
-        }
+    mapped_type const &at(key_type const &k) const {
+        ref const l = lookup(k, 0);
+        if ( !l ) throw std::out_of_range("assist: trie::at");
+        return leaf(l)->second;
     }
-    const_iterator find(const key_type &k) const {
-        const_iterator it = lower_bound(k);
-        if ( it == end() || comparator(k, *it) ) {
-            return end();
-        } else {
-            return it;
+
+    // Modifiers
+    std::pair<iterator, bool> insert(value_type const &v) {
+        std::pair<ref, bool> const r = insert_leaf(v);
+        detail::trie_path path;
+        lookup(v.first, &path);
+        return std::make_pair(iterator(nodes, path, r.first), r.second);
+    }
+    template <class InputIterator>
+    void insert(InputIterator b, InputIterator const e) {
+        for ( ; b != e; ++b ) insert_leaf(*b);
+    }
+    void erase(iterator it) { erase(it->first); }
+    size_type erase(key_type const &k) {
+        size_type const size = key_traits.size(k);
+        ref *slot = &root;
+        // the slot of the node *slot hangs from, and where that starts
+        ref *parent = 0;
+        size_type parent_depth = 0;
+        int pos = 0;
+        size_type depth = 0;
+        for ( ;; ) {
+            ref const n = *slot;
+            if ( !n ) return 0;
+            if ( detail::is_trie_leaf(n) ) {
+                if ( !same_key(key_of(n), k) ) return 0;
+                nodes->delete_leaf(n);
+                --items;
+                if ( parent ) {
+                    detail::remove_child(inner_of(*parent), pos);
+                    collapse(parent, parent_depth);
+                } else {
+                    *slot = 0;
+                }
+                return 1;
+            }
+            inner *const p = inner_of(n);
+            if ( !may_match_prefix(p, k, depth) ) return 0;
+            size_type const start = depth;
+            depth += p->prefix_len;
+            if ( depth == size ) {
+                if ( !p->value || !same_key(key_of(p->value), k) ) return 0;
+                nodes->delete_leaf(p->value);
+                p->value = 0;
+                --items;
+                collapse(slot, start);
+                return 1;
+            }
+            pos = detail::find_child(p, key_traits.get(k, depth++));
+            if ( pos < 0 ) return 0;
+            parent = slot;
+            parent_depth = start;
+            slot = &detail::child_at(p, pos);
         }
     }
-    iterator lower_bound(const key_type &k) {
-        return std::lower_bound(begin(), end(), k, value_comp());
+    void swap(trie &other) {
+        std::swap( key_traits, other.key_traits );
+        std::swap( nodes, other.nodes );
+        std::swap( root, other.root );
+        std::swap( items, other.items );
     }
-    const_iterator lower_bound(const key_type &k) const {
-        return std::lower_bound(begin(), end(), k, value_comp());
+    // Keeps nothing: the pools go back to the heap whole
+    void clear() {
+        destroy();
+        nodes = 0;
+        root = 0;
+        items = 0;
     }
-    iterator upper_bound(const key_type &k) {
-        return std::upper_bound(begin(), end(), k, value_comp());
+
+    // Observers
+    traits_type traits() const { return key_traits; }
+
+    // Map operations
+    size_type count(key_type const &k) const {
+        return contains(k) ? 1 : 0;
     }
-    const_iterator upper_bound(const key_type &k) const {
-        return std::upper_bound(begin(), end(), k, value_comp());
+    iterator find(key_type const &k) {
+        detail::trie_path path;
+        ref const l = lookup(k, &path);
+        return l ? iterator(nodes, path, l) : end();
     }
-    bool contains(const key_type &k) const {
-        return std::binary_search(begin(), end(), k, value_comp());
+    const_iterator find(key_type const &k) const {
+        detail::trie_path path;
+        ref const l = lookup(k, &path);
+        return l ? const_iterator(nodes, path, l) : end();
     }
-  
+    bool contains(key_type const &k) const {
+        return lookup(k, 0) != 0;
+    }
+
+    // Prefix operations
+    // The element whose key is the longest prefix of k, or end().
+    // Neither these nor find allocate, unless the keys branch more
+    // than 16 times along the way.
+    iterator longest_prefix_match(key_type const &k) {
+        detail::trie_path path;
+        ref const l = longest_prefix(k, path);
+        return l ? iterator(nodes, path, l) : end();
+    }
+    const_iterator longest_prefix_match(key_type const &k) const {
+        detail::trie_path path;
+        ref const l = longest_prefix(k, path);
+        return l ? const_iterator(nodes, path, l) : end();
+    }
+    // The elements whose keys start with prefix, in order
+    std::pair<iterator, iterator> prefix_range(key_type const &prefix) {
+        detail::trie_path path;
+        ref const n = prefix_root(prefix, path);
+        if ( !n ) return std::make_pair(end(), end());
+        return std::make_pair(iterator(nodes, path, n),
+                              iterator(nodes, path));
+    }
+    std::pair<const_iterator, const_iterator>
+    prefix_range(key_type const &prefix) const {
+        detail::trie_path path;
+        ref const n = prefix_root(prefix, path);
+        if ( !n ) return std::make_pair(end(), end());
+        return std::make_pair(const_iterator(nodes, path, n),
+                              const_iterator(nodes, path));
+    }
+    // How many keys start with prefix; O(their number)
+    size_type count_prefix(key_type const &prefix) const {
+        detail::trie_path path;
+        ref const n = prefix_root(prefix, path);
+        return n ? nodes->count_leaves(n) : 0;
+    }
+
+    // Extra
+    // Bytes held for the nodes, including free slots
+    size_type node_bytes() const { return nodes ? nodes->bytes() : 0; }
+
     // Comparison Operators
-    bool operator==(set_adapter const &other) { return c == other.c; }
-    bool operator!=(set_adapter const &other) { return c != other.c; }
-    bool operator<(set_adapter const &other) { return c < other.c; }
-    bool operator<=(set_adapter const &other) { return c <= other.c; }
-    bool operator>(set_adapter const &other) { return c > other.c; }
-    bool operator>=(set_adapter const &other) { return c >= other.c; }
+    bool operator==(trie const &other) const {
+        return size() == other.size() &&
+               std::equal(begin(), end(), other.begin());
+    }
+    bool operator!=(trie const &other) const {
+        return !(*this == other);
+    }
 };
 
 // Overloaded Algorithms
-template < typename base_type,
-            typename CMP >
-void swap(set_adapter<base_type,CMP> const &lhs,
-          set_adapter<base_type,CMP> const &rhs) {
-    lhs.swap(rhs);
-}
-template < typename base_type,
-            typename CMP >
-void swap(base_type const &lhs,
-          set_adapter<base_type,CMP> const &rhs) {
-    lhs.swap(rhs);
-}
-template < typename base_type,
-            typename CMP >
-void swap(set_adapter<base_type,CMP> const &lhs,
-          base_type const &rhs) {
+template < typename Key, typename T, typename Traits >
+void swap(trie<Key, T, Traits> &lhs, trie<Key, T, Traits> &rhs) {
     lhs.swap(rhs);
 }
 
 } // namespace assist
 
-#ifndef ASSIST_NO_NAMESPACE_STD_ADDITIONS
-namespace std {
-
-// Overloaded Algorithms
-template < typename base_type,
-            typename CMP >
-void swap(assist::set_adapter<base_type,CMP> const &lhs,
-          assist::set_adapter<base_type,CMP> const &rhs) {
-    assist::swap(lhs,rhs);
-}
-template < typename base_type,
-            typename CMP >
-void swap(base_type const &lhs,
-          assist::set_adapter<base_type,CMP> const &rhs) {
-    assist::swap(lhs,rhs);
-}
-template < typename base_type,
-            typename CMP >
-void swap(assist::set_adapter<base_type,CMP> const &lhs,
-          base_type const &rhs) {
-    assist::swap(lhs,rhs);
-}
-
-} // namespace std
-#endif
-
 #endif
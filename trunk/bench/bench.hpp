@@ -0,0 +1,250 @@
+#ifndef ASSIST_BENCH_BENCH_HPP
+#define ASSIST_BENCH_BENCH_HPP
+
+/*
+ * bench/bench.hpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* What the benchmark programs share: command-line options, timing,
+ * key generation and the report every result goes to, one row each, as
+ * CSV or (with --json) a JSON array of objects.  The columns are
+ *
+ *     suite,operation,container,key,n,ops,value,unit
+ *
+ * where n is the element count the operation ran against, ops how many
+ * operations were timed, and value is in unit (ns/op, bytes/element,
+ * ...).  Every program takes
+ *
+ *     --min=N --max=N   element counts, stepping by 10 (1e2 to 1e8)
+ *     --ops=N           operations timed per measurement (1e5)
+ *     --budget=S        seconds a measurement may take before it stops
+ *                       early and reports the operations done (1)
+ *     --filter=S        only what has S in its container/key name
+ *     --threads=N       threads, for the programs that use them
+ *     --json            JSON instead of CSV
+ *
+ * Counts can be written as 1e6.  Bytes are those that went through
+ * operator new (see memory.cpp).
+ */
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib> // strtod, exit
+#include <cstring> // strncmp, strcmp
+#include <cstddef> // size_t
+#include <cstdint>
+#include <algorithm> // sort, min
+
+namespace bench {
+
+struct options {
+    std::size_t min_n, max_n;
+    std::size_t ops;
+    double budget;
+    std::string filter;
+    unsigned threads;
+    bool json;
+    options()
+     : min_n(100), max_n(100000000), ops(100000), budget(1),
+       threads(4), json(false) {}
+
+    bool wanted(std::string const &container, std::string const &key) const {
+        return filter.empty()
+            || ( container + "/" + key ).find(filter) != std::string::npos;
+    }
+    // Element counts to run, min_n to max_n by factors of 10
+    std::vector<std::size_t> sizes() const {
+        std::vector<std::size_t> r;
+        for ( std::size_t n = min_n; n <= max_n; n *= 10 ) r.push_back(n);
+        return r;
+    }
+};
+
+inline std::size_t parse_count(char const *s) {
+    return std::size_t(std::strtod(s, 0));
+}
+
+// Exits with a usage message on anything it doesn't know
+inline options parse(int argc, char **argv, options o = options()) {
+    for ( int i = 1; i != argc; ++i ) {
+        char const *a = argv[i];
+        if ( !std::strncmp(a, "--min=", 6) ) o.min_n = parse_count(a+6);
+        else if ( !std::strncmp(a, "--max=", 6) ) o.max_n = parse_count(a+6);
+        else if ( !std::strncmp(a, "--ops=", 6) ) o.ops = parse_count(a+6);
+        else if ( !std::strncmp(a, "--budget=", 9) ) o.budget = std::strtod(a+9, 0);
+        else if ( !std::strncmp(a, "--filter=", 9) ) o.filter = a+9;
+        else if ( !std::strncmp(a, "--threads=", 10) ) o.threads = unsigned(parse_count(a+10));
+        else if ( !std::strcmp(a, "--json") ) o.json = true;
+        else {
+            std::fprintf(stderr, "usage: %s [--min=N] [--max=N] [--ops=N] "
+                         "[--budget=S] [--filter=S] [--threads=N] [--json]\n",
+                         argv[0]);
+            std::exit(2);
+        }
+    }
+    if ( !o.min_n ) o.min_n = 1;
+    if ( !o.threads ) o.threads = 1;
+    return o;
+}
+
+// Writes rows to stdout as they come, so a long run can be watched
+class report {
+    std::string suite;
+    bool json;
+    bool first;
+  public:
+    report(std::string const &name, options const &o)
+     : suite(name), json(o.json), first(true) {
+        if ( json ) std::printf("[\n");
+        else std::printf("suite,operation,container,key,n,ops,value,unit\n");
+        std::fflush(stdout);
+    }
+    ~report() {
+        if ( json ) std::printf("\n]\n");
+    }
+    void row(std::string const &operation, std::string const &container,
+             std::string const &key, std::size_t n, std::size_t ops,
+             double value, char const *unit) {
+        if ( json ) {
+            std::printf("%s  {\"suite\": \"%s\", \"operation\": \"%s\", "
+                        "\"container\": \"%s\", \"key\": \"%s\", "
+                        "\"n\": %lu, \"ops\": %lu, \"value\": %.6g, "
+                        "\"unit\": \"%s\"}",
+                        first ? "" : ",\n", suite.c_str(), operation.c_str(),
+                        container.c_str(), key.c_str(),
+                        (unsigned long)n, (unsigned long)ops, value, unit);
+        } else {
+            std::printf("%s,%s,%s,%s,%lu,%lu,%.6g,%s\n",
+                        suite.c_str(), operation.c_str(), container.c_str(),
+                        key.c_str(), (unsigned long)n, (unsigned long)ops,
+                        value, unit);
+        }
+        first = false;
+        std::fflush(stdout);
+    }
+};
+
+// Timing
+
+typedef std::chrono::steady_clock clock;
+
+inline double seconds_since(clock::time_point start) {
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+struct timing {
+    std::size_t ops;
+    double seconds;
+    double ns_per_op() const { return ops ? seconds * 1e9 / ops : 0; }
+};
+
+// Calls f(i) for i in [0,ops), stopping early once budget seconds
+// have gone by; the clock is read every 64 calls.
+template < typename F >
+timing run(std::size_t ops, double budget, F f) {
+    clock::time_point const start = clock::now();
+    std::size_t i = 0;
+    while ( i != ops ) {
+        std::size_t const stop = std::min(ops, i + 64);
+        for ( ; i != stop; ++i ) f(i);
+        if ( seconds_since(start) > budget ) break;
+    }
+    timing const t = { i, seconds_since(start) };
+    return t;
+}
+// Times f() once
+template < typename F >
+double once(F f) {
+    clock::time_point const start = clock::now();
+    f();
+    return seconds_since(start);
+}
+
+// Keeps a result alive, so the work producing it can't be optimised away
+template < typename T >
+inline void keep(T const &v) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(v) : "memory");
+#else
+    static volatile char sink;
+    sink = *reinterpret_cast<char const volatile *>(&v);
+#endif
+}
+
+// Memory (memory.cpp)
+
+// Bytes currently allocated through operator new
+std::size_t live_bytes();
+// Calls to operator new so far
+std::size_t allocations();
+
+// Keys
+
+// A bijection on the low bits bits of x, so distinct i give distinct keys
+inline std::uint64_t mix(std::uint64_t x, unsigned bits) {
+    std::uint64_t const m = bits == 64 ? ~std::uint64_t(0)
+                                       : ( std::uint64_t(1) << bits ) - 1;
+    unsigned const s = bits / 2;
+    x &= m;
+    x ^= x >> s;
+    x = ( x * 0x9E3779B97F4A7C15ull ) & m;
+    x ^= x >> s;
+    x = ( x * 0xBF58476D1CE4E5B9ull ) & m;
+    x ^= x >> s;
+    return x;
+}
+
+// The i-th key of each type; distinct for distinct i
+template < typename K > struct keys;
+template <>
+struct keys<std::uint32_t> {
+    static char const *name() { return "u32"; }
+    static std::uint32_t make(std::uint64_t i) { return std::uint32_t(mix(i, 32)); }
+};
+template <>
+struct keys<std::uint64_t> {
+    static char const *name() { return "u64"; }
+    static std::uint64_t make(std::uint64_t i) { return mix(i, 64); }
+};
+template <>
+struct keys<double> {
+    static char const *name() { return "f64"; }
+    // exact in a double's 53 bits
+    static double make(std::uint64_t i) { return double(mix(i, 53)); }
+};
+template <>
+struct keys<std::string> {
+    static char const *name() { return "str16"; }
+    static std::string make(std::uint64_t i) {
+        char buffer[17];
+        std::snprintf(buffer, sizeof(buffer), "%016llx",
+                      (unsigned long long)mix(i, 64));
+        return std::string(buffer, 16);
+    }
+};
+
+// Keys first..first+n-1, in their pseudo-random order
+template < typename K >
+std::vector<K> make_keys(std::uint64_t first, std::size_t n) {
+    std::vector<K> r;
+    r.reserve(n);
+    for ( std::size_t i = 0; i != n; ++i ) r.push_back(keys<K>::make(first+i));
+    return r;
+}
+template < typename K >
+std::vector<K> sorted(std::vector<K> v) {
+    std::sort(v.begin(), v.end());
+    return v;
+}
+
+} // namespace bench
+
+#endif
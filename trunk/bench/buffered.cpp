@@ -0,0 +1,104 @@
+/*
+ * bench/buffered.cpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* buffered_adapter against inserting straight into the adapter, for
+ * set_adapter and map_adapter, building n elements from empty one
+ * random key at a time:
+ *
+ *     insert           inserts per second, over the whole build
+ *     find_hit         afterwards, as every level is probed
+ *
+ * The buffered rows are run at several merge thresholds, named
+ * "buffered_adapter<set_adapter>/1024", to weigh cheaper inserts
+ * against more levels to search.  Straight inserts shift the vector's
+ * tail, so at large n they stop at --budget, and find_hit then looks
+ * up only the keys that went in.
+ */
+
+#include <vector>
+#include <string>
+#include <utility> // pair
+#include <cstdio> // snprintf
+#include <cstdint>
+
+#include "bench.hpp"
+#include "../assist/set_adapter.hpp"
+#include "../assist/map_adapter.hpp"
+#include "../assist/buffered_adapter.hpp"
+
+namespace {
+
+std::size_t const thresholds[] = { 64, 256, 1024, 4096, 16384 };
+
+template < typename K >
+K element(K const &k, K const *) { return k; }
+template < typename K, typename V >
+std::pair<K, V> element(K const &k, std::pair<K, V> const *) {
+    return std::pair<K, V>(k, 0);
+}
+
+// Builds s from empty with keys, then looks them up again
+template < typename S, typename K >
+void measure(bench::report &out, bench::options const &o,
+             std::string const &name, S &s, std::vector<K> const &keys) {
+    typedef typename S::value_type value_type;
+    char const *const key = bench::keys<K>::name();
+    std::size_t const n = keys.size();
+    bench::timing t = bench::run(n, o.budget, [&](std::size_t i) {
+        s.insert(element(keys[i], (value_type const *)0));
+    });
+    out.row("insert", name, key, n, t.ops, t.ops / t.seconds, "inserts/s");
+    std::size_t const present = t.ops;
+    t = bench::run(o.ops, o.budget, [&](std::size_t i) {
+        bench::keep(s.count(keys[i % present]));
+    });
+    out.row("find_hit", name, key, n, t.ops, t.ns_per_op(), "ns/op");
+}
+
+template < typename A, typename K >
+void measure_all(bench::report &out, bench::options const &o,
+                 char const *name, std::vector<K> const &keys) {
+    char const *const key = bench::keys<K>::name();
+    if ( o.wanted(name, key) ) {
+        A a;
+        measure(out, o, name, a, keys);
+    }
+    for ( std::size_t i = 0; i != sizeof(thresholds)/sizeof(*thresholds); ++i ) {
+        char buffered[64];
+        std::snprintf(buffered, sizeof(buffered), "buffered_adapter<%s>/%lu",
+                      name, (unsigned long)thresholds[i]);
+        if ( !o.wanted(buffered, key) ) continue;
+        assist::buffered_adapter<A> b(thresholds[i]);
+        measure(out, o, buffered, b, keys);
+    }
+}
+
+template < typename K >
+void run(bench::report &out, bench::options const &o) {
+    typedef std::pair<K, std::uint64_t> P;
+    std::vector<std::size_t> const sizes = o.sizes();
+    for ( std::size_t i = 0; i != sizes.size(); ++i ) {
+        std::vector<K> const keys = bench::make_keys<K>(0, sizes[i]);
+        measure_all<assist::set_adapter< std::vector<K> > >(
+            out, o, "set_adapter", keys);
+        measure_all<assist::map_adapter< std::vector<P> > >(
+            out, o, "map_adapter", keys);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::options const o = bench::parse(argc, argv);
+    bench::report out("buffered", o);
+    run<std::uint32_t>(out, o);
+    run<std::uint64_t>(out, o);
+    run<std::string>(out, o);
+}
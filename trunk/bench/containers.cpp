@@ -0,0 +1,222 @@
+/*
+ * bench/containers.cpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* The sorted adapters against the standard tree and hash containers,
+ * for each key type and element count:
+ *
+ *     construct        from n elements in random order, ns/element
+ *     memory           bytes per element after constructing
+ *     insert_random    new keys in random order, into n elements
+ *     insert_sequential  keys above all n, ascending
+ *     insert_hinted    the same, with end() as the hint
+ *     find_hit, find_miss
+ *     range_scan_100   lower_bound, then 100 elements on (ordered only)
+ *     erase            keys present, in random order
+ *
+ * The insert and erase costs of the adapters grow with n, so at large
+ * n those stop at --budget and report the operations they got through.
+ */
+
+#include <set>
+#include <map>
+#include <unordered_set>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <utility> // pair
+#include <algorithm> // min, max
+#include <type_traits> // integral_constant
+#include <cstdint>
+
+#include "bench.hpp"
+#include "../assist/set_adapter.hpp"
+#include "../assist/map_adapter.hpp"
+#include "../assist/multiset_adapter.hpp"
+#include "../assist/multimap_adapter.hpp"
+
+namespace {
+
+// What the containers hold, made from a key
+template < typename K, bool Map > struct element;
+template < typename K >
+struct element<K, false> {
+    typedef K type;
+    static K make(K const &k) { return k; }
+};
+template < typename K >
+struct element<K, true> {
+    typedef std::pair<K, std::uint64_t> type;
+    static type make(K const &k) { return type(k, 0); }
+};
+
+// The keys for one key type and element count
+template < typename K >
+struct data {
+    std::size_t n;
+    // n keys in random order, and others in random order
+    std::vector<K> hits, misses;
+    // the n smallest of all those in order, and the rest in order
+    std::vector<K> base, tail;
+    data(std::size_t count, std::size_t ops)
+     : n(count), hits(bench::make_keys<K>(0, count)),
+       misses(bench::make_keys<K>(count, ops)) {
+        std::vector<K> all(hits);
+        all.insert(all.end(), misses.begin(), misses.end());
+        all = bench::sorted(all);
+        base.assign(all.begin(), all.begin()+n);
+        tail.assign(all.begin()+n, all.end());
+    }
+};
+
+template < typename E, typename K, bool Map >
+std::vector<E> elements(std::vector<K> const &keys) {
+    std::vector<E> r;
+    r.reserve(keys.size());
+    for ( std::size_t i = 0; i != keys.size(); ++i ) {
+        r.push_back(element<K, Map>::make(keys[i]));
+    }
+    return r;
+}
+
+// range_scan_100; the hash containers have no order to scan in
+template < typename C, typename K >
+void measure_scan(bench::report &out, bench::options const &o,
+                  char const *name, C const &c, data<K> const &d,
+                  std::true_type) {
+    bench::timing const t = bench::run(o.ops, o.budget, [&](std::size_t i) {
+        std::size_t seen = 0;
+        typename C::const_iterator it =
+            c.lower_bound(d.misses[i % d.misses.size()]);
+        for ( ; it != c.end() && seen != 100; ++it ) {
+            bench::keep(&*it);
+            ++seen;
+        }
+        bench::keep(seen);
+    });
+    out.row("range_scan_100", name, bench::keys<K>::name(), d.n,
+            t.ops, t.ns_per_op(), "ns/op");
+}
+template < typename C, typename K >
+void measure_scan(bench::report &, bench::options const &,
+                  char const *, C const &, data<K> const &,
+                  std::false_type) {}
+
+template < typename C, typename K, bool Map, bool Ordered >
+void measure(bench::report &out, bench::options const &o, char const *name,
+             data<K> const &d) {
+    char const *const key = bench::keys<K>::name();
+    if ( !o.wanted(name, key) ) return;
+    typedef typename element<K, Map>::type E;
+    typedef element<K, Map> make;
+    std::size_t const n = d.n;
+    std::vector<E> const from_hits = elements<E, K, Map>(d.hits);
+    std::vector<E> const from_base = elements<E, K, Map>(d.base);
+
+    // inserts at most double the size
+    std::size_t const inserts = std::min(o.ops, n);
+
+    {
+        // small sizes are built several times over, for a steadier time
+        std::size_t const builds = std::max<std::size_t>(1, o.ops / n);
+        std::size_t before = 0;
+        C *c = 0;
+        double const s = bench::once([&]{
+            for ( std::size_t i = 0; i != builds; ++i ) {
+                delete c;
+                before = bench::live_bytes();
+                c = new C(from_hits.begin(), from_hits.end());
+            }
+        });
+        std::size_t const bytes = bench::live_bytes() - before - sizeof(C);
+        out.row("construct", name, key, n, n*builds, s * 1e9 / (n*builds),
+                "ns/element");
+        out.row("memory", name, key, n, n, double(bytes) / n, "bytes/element");
+
+        bench::timing t = bench::run(o.ops, o.budget, [&](std::size_t i) {
+            bench::keep(c->find(d.hits[i % n]) != c->end());
+        });
+        out.row("find_hit", name, key, n, t.ops, t.ns_per_op(), "ns/op");
+        t = bench::run(o.ops, o.budget, [&](std::size_t i) {
+            bench::keep(c->find(d.misses[i % d.misses.size()]) != c->end());
+        });
+        out.row("find_miss", name, key, n, t.ops, t.ns_per_op(), "ns/op");
+        measure_scan(out, o, name, *c, d,
+                     std::integral_constant<bool, Ordered>());
+        t = bench::run(inserts, o.budget, [&](std::size_t i) {
+            c->insert(make::make(d.misses[i]));
+        });
+        out.row("insert_random", name, key, n, t.ops, t.ns_per_op(), "ns/op");
+        delete c;
+    }
+    {
+        C c(from_hits.begin(), from_hits.end());
+        bench::timing const t = bench::run(inserts, o.budget,
+                                           [&](std::size_t i) {
+            c.erase(d.hits[i]);
+        });
+        out.row("erase", name, key, n, t.ops, t.ns_per_op(), "ns/op");
+    }
+    {
+        C c(from_base.begin(), from_base.end());
+        bench::timing const t = bench::run(inserts, o.budget,
+                                           [&](std::size_t i) {
+            c.insert(make::make(d.tail[i]));
+        });
+        out.row("insert_sequential", name, key, n, t.ops, t.ns_per_op(), "ns/op");
+    }
+    {
+        C c(from_base.begin(), from_base.end());
+        bench::timing const t = bench::run(inserts, o.budget,
+                                           [&](std::size_t i) {
+            c.insert(c.end(), make::make(d.tail[i]));
+        });
+        out.row("insert_hinted", name, key, n, t.ops, t.ns_per_op(), "ns/op");
+    }
+}
+
+template < typename K >
+void run(bench::report &out, bench::options const &o) {
+    typedef std::pair<K, std::uint64_t> P;
+    std::vector<std::size_t> const sizes = o.sizes();
+    for ( std::size_t i = 0; i != sizes.size(); ++i ) {
+        data<K> const d(sizes[i], o.ops);
+        measure<assist::set_adapter< std::vector<K> >, K, false, true>(
+            out, o, "set_adapter", d);
+        measure<assist::multiset_adapter< std::vector<K> >, K, false, true>(
+            out, o, "multiset_adapter", d);
+        measure<std::set<K>, K, false, true>(
+            out, o, "std::set", d);
+        measure<std::multiset<K>, K, false, true>(
+            out, o, "std::multiset", d);
+        measure<std::unordered_set<K>, K, false, false>(
+            out, o, "std::unordered_set", d);
+        measure<assist::map_adapter< std::vector<P> >, K, true, true>(
+            out, o, "map_adapter", d);
+        measure<assist::multimap_adapter< std::vector<P> >, K, true, true>(
+            out, o, "multimap_adapter", d);
+        measure<std::map<K, std::uint64_t>, K, true, true>(
+            out, o, "std::map", d);
+        measure<std::multimap<K, std::uint64_t>, K, true, true>(
+            out, o, "std::multimap", d);
+        measure<std::unordered_map<K, std::uint64_t>, K, true, false>(
+            out, o, "std::unordered_map", d);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::options const o = bench::parse(argc, argv);
+    bench::report out("containers", o);
+    run<std::uint32_t>(out, o);
+    run<std::uint64_t>(out, o);
+    run<double>(out, o);
+    run<std::string>(out, o);
+}
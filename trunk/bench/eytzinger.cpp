@@ -0,0 +1,161 @@
+/*
+ * bench/eytzinger.cpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* eytzinger_index against the adapters' own searches over the sorted
+ * layout, for set_adapter and map_adapter:
+ *
+ *     build            making the index, ns/element
+ *     memory           the index's bytes per element
+ *     lower_bound      random keys, half of them present
+ *     find_hit, find_miss
+ *
+ * The adapter rows ("set_adapter") are the current layout; the index
+ * rows ("eytzinger_index<set_adapter>") search the same contents.
+ * The two take turns, and each lookup row is its fastest of three
+ * rounds.
+ */
+
+#include <vector>
+#include <string>
+#include <utility> // pair
+#include <algorithm> // max
+#include <cstdint>
+
+#include "bench.hpp"
+#include "../assist/set_adapter.hpp"
+#include "../assist/map_adapter.hpp"
+#include "../assist/eytzinger_index.hpp"
+
+namespace {
+
+template < typename K >
+struct data {
+    std::size_t n;
+    std::vector<K> hits, misses, mixed;
+    data(std::size_t count, std::size_t ops)
+     : n(count), hits(bench::make_keys<K>(0, count)),
+       misses(bench::make_keys<K>(count, ops)) {
+        for ( std::size_t i = 0; i != ops; ++i ) {
+            mixed.push_back(i % 2 ? misses[i] : hits[i % n]);
+        }
+    }
+};
+
+// Times f and g in turn, three rounds of a third of the budget each,
+// keeping the fastest round of each: the layouts are close enough that
+// a noisy stretch of machine would otherwise decide between them
+template < typename F, typename G >
+void race(bench::options const &o, std::size_t ops, bool run_f, F f,
+          bool run_g, G g, bench::timing &tf, bench::timing &tg) {
+    for ( int i = 0; i != 3; ++i ) {
+        if ( run_f ) {
+            bench::timing const t = bench::run(ops, o.budget / 3, f);
+            if ( !i || t.ns_per_op() < tf.ns_per_op() ) tf = t;
+        }
+        if ( run_g ) {
+            bench::timing const t = bench::run(ops, o.budget / 3, g);
+            if ( !i || t.ns_per_op() < tg.ns_per_op() ) tg = t;
+        }
+    }
+}
+
+void row(bench::report &out, char const *operation, std::string const &name,
+         char const *key, std::size_t n, bench::timing const &t) {
+    out.row(operation, name, key, n, t.ops, t.ns_per_op(), "ns/op");
+}
+
+// The lookups, through the adapter and through an index over it
+template < typename A, typename E, typename K >
+void lookups(bench::report &out, bench::options const &o,
+             std::string const &name, A const *a,
+             std::string const &indexed, E const *e, data<K> const &d) {
+    char const *const key = bench::keys<K>::name();
+    bench::timing ta, te;
+    race(o, d.mixed.size(), a != 0, [&](std::size_t i) {
+        bench::keep(a->lower_bound(d.mixed[i]) - a->begin());
+    }, e != 0, [&](std::size_t i) {
+        bench::keep(e->lower_bound(d.mixed[i]) - e->base().begin());
+    }, ta, te);
+    if ( a ) row(out, "lower_bound", name, key, d.n, ta);
+    if ( e ) row(out, "lower_bound", indexed, key, d.n, te);
+    race(o, o.ops, a != 0, [&](std::size_t i) {
+        bench::keep(a->find(d.hits[i % d.n]) != a->end());
+    }, e != 0, [&](std::size_t i) {
+        bench::keep(e->find(d.hits[i % d.n]) != e->base().end());
+    }, ta, te);
+    if ( a ) row(out, "find_hit", name, key, d.n, ta);
+    if ( e ) row(out, "find_hit", indexed, key, d.n, te);
+    race(o, d.misses.size(), a != 0, [&](std::size_t i) {
+        bench::keep(a->find(d.misses[i]) != a->end());
+    }, e != 0, [&](std::size_t i) {
+        bench::keep(e->find(d.misses[i]) != e->base().end());
+    }, ta, te);
+    if ( a ) row(out, "find_miss", name, key, d.n, ta);
+    if ( e ) row(out, "find_miss", indexed, key, d.n, te);
+}
+
+template < typename A, typename E, typename K >
+void measure(bench::report &out, bench::options const &o, char const *name,
+             data<K> const &d, std::vector<E> const &elements) {
+    char const *const key = bench::keys<K>::name();
+    std::string const indexed = std::string("eytzinger_index<") + name + ">";
+    bool const base = o.wanted(name, key), index = o.wanted(indexed, key);
+    if ( !base && !index ) return;
+
+    A const a(elements.begin(), elements.end());
+    assist::eytzinger_index<A> *e = 0;
+    if ( index ) {
+        std::size_t const builds = std::max<std::size_t>(1, o.ops / d.n);
+        std::size_t before = 0;
+        double const s = bench::once([&]{
+            for ( std::size_t i = 0; i != builds; ++i ) {
+                delete e;
+                before = bench::live_bytes();
+                e = new assist::eytzinger_index<A>(a);
+            }
+        });
+        std::size_t const bytes = bench::live_bytes() - before - sizeof(*e);
+        out.row("build", indexed, key, d.n, d.n*builds,
+                s * 1e9 / (d.n*builds), "ns/element");
+        out.row("memory", indexed, key, d.n, d.n, double(bytes) / d.n,
+                "bytes/element");
+    }
+    lookups(out, o, name, base ? &a : 0, indexed, e, d);
+    delete e;
+}
+
+template < typename K >
+void run(bench::report &out, bench::options const &o) {
+    typedef std::pair<K, std::uint64_t> P;
+    std::vector<std::size_t> const sizes = o.sizes();
+    for ( std::size_t i = 0; i != sizes.size(); ++i ) {
+        data<K> const d(sizes[i], o.ops);
+        measure<assist::set_adapter< std::vector<K> > >(
+            out, o, "set_adapter", d, d.hits);
+        std::vector<P> pairs;
+        pairs.reserve(d.n);
+        for ( std::size_t j = 0; j != d.n; ++j ) {
+            pairs.push_back(P(d.hits[j], j));
+        }
+        measure<assist::map_adapter< std::vector<P> > >(
+            out, o, "map_adapter", d, pairs);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::options const o = bench::parse(argc, argv);
+    bench::report out("eytzinger", o);
+    run<std::uint32_t>(out, o);
+    run<std::uint64_t>(out, o);
+    run<double>(out, o);
+    run<std::string>(out, o);
+}
@@ -0,0 +1,143 @@
+/*
+ * bench/hinted.cpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* Building a container one insert at a time from n keys that arrive
+ *
+ *     sorted           ascending, as timestamps do
+ *     reverse          descending
+ *     near_sorted      ascending, but each key up to 16 places from
+ *                      where it belongs
+ *
+ * The key column names the order, as "u64:near_sorted".  Each stream is
+ * inserted three ways:
+ *
+ *     insert           no hint
+ *     insert_hint_end  end() as the hint
+ *     insert_hint_last the iterator the previous insert returned
+ *
+ * into the four adapters and std::set and std::map, reporting ns/insert.
+ * Reverse streams shift the whole vector on every insert, so at large n
+ * those stop at --budget and report the inserts they got through.
+ */
+
+#include <set>
+#include <map>
+#include <vector>
+#include <string>
+#include <utility> // pair, swap
+#include <cstdint>
+
+#include "bench.hpp"
+#include "../assist/set_adapter.hpp"
+#include "../assist/map_adapter.hpp"
+#include "../assist/multiset_adapter.hpp"
+#include "../assist/multimap_adapter.hpp"
+
+namespace {
+
+typedef std::uint64_t K;
+
+// What a container holds, made from a key
+template < typename V >
+struct element {
+    static V make(K k) { return V(k, k); }
+};
+template <>
+struct element<K> {
+    static K make(K k) { return k; }
+};
+
+// The n keys of each order
+std::vector<K> sorted_stream(std::size_t n) {
+    std::vector<K> v;
+    v.reserve(n);
+    for ( std::size_t i = 0; i != n; ++i ) v.push_back(K(i) * 16);
+    return v;
+}
+std::vector<K> reverse_stream(std::size_t n) {
+    std::vector<K> v = sorted_stream(n);
+    for ( std::size_t i = 0, j = n; i < j--; ++i ) std::swap(v[i], v[j]);
+    return v;
+}
+std::vector<K> near_sorted_stream(std::size_t n) {
+    std::vector<K> v = sorted_stream(n);
+    for ( std::size_t i = 0; i + 16 < n; ++i ) {
+        std::swap(v[i], v[i + bench::mix(i, 64) % 16]);
+    }
+    return v;
+}
+
+enum hint_kind { no_hint, hint_end, hint_last };
+
+template < typename C >
+void measure(bench::report &out, bench::options const &o, char const *name,
+             std::string const &key, std::vector<K> const &stream,
+             hint_kind hint) {
+    if ( !o.wanted(name, key) ) return;
+    typedef typename C::value_type V;
+    C c;
+    typename C::iterator last = c.end();
+    bench::timing t;
+    switch ( hint ) {
+      case no_hint:
+        t = bench::run(stream.size(), o.budget, [&](std::size_t i) {
+            c.insert(element<V>::make(stream[i]));
+        });
+        break;
+      case hint_end:
+        t = bench::run(stream.size(), o.budget, [&](std::size_t i) {
+            c.insert(c.end(), element<V>::make(stream[i]));
+        });
+        break;
+      case hint_last:
+        t = bench::run(stream.size(), o.budget, [&](std::size_t i) {
+            last = c.insert(last, element<V>::make(stream[i]));
+        });
+        break;
+    }
+    bench::keep(c.size());
+    static char const *const operations[] = {
+        "insert", "insert_hint_end", "insert_hint_last"
+    };
+    out.row(operations[hint], name, key, stream.size(), t.ops, t.ns_per_op(),
+            "ns/insert");
+}
+
+void measure_all(bench::report &out, bench::options const &o,
+                 char const *order, std::vector<K> const &stream) {
+    std::string const key = std::string(bench::keys<K>::name()) + ":" + order;
+    for ( int h = no_hint; h <= hint_last; ++h ) {
+        hint_kind const hint = hint_kind(h);
+        measure< assist::set_adapter< std::vector<K> > >(
+            out, o, "set_adapter", key, stream, hint);
+        measure< assist::multiset_adapter< std::vector<K> > >(
+            out, o, "multiset_adapter", key, stream, hint);
+        measure< assist::map_adapter< std::vector< std::pair<K, K> > > >(
+            out, o, "map_adapter", key, stream, hint);
+        measure< assist::multimap_adapter< std::vector< std::pair<K, K> > > >(
+            out, o, "multimap_adapter", key, stream, hint);
+        measure< std::set<K> >(out, o, "std::set", key, stream, hint);
+        measure< std::map<K, K> >(out, o, "std::map", key, stream, hint);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::options const o = bench::parse(argc, argv);
+    bench::report out("hinted", o);
+    std::vector<std::size_t> const sizes = o.sizes();
+    for ( std::size_t i = 0; i != sizes.size(); ++i ) {
+        // one stream at a time, to keep the largest runs in memory
+        measure_all(out, o, "sorted", sorted_stream(sizes[i]));
+        measure_all(out, o, "reverse", reverse_stream(sizes[i]));
+        measure_all(out, o, "near_sorted", near_sorted_stream(sizes[i]));
+    }
+}
@@ -0,0 +1,135 @@
+/*
+ * bench/learned.cpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* learned_index against binary search, on keys drawn three ways:
+ *
+ *     uniform          evenly over the key range
+ *     skewed           u^8 for u uniform in [0,1), bunched near zero
+ *     clustered        dense runs around 64 random centres
+ *
+ * The key column names both, as "u64:skewed".  Lookups are lower_bound
+ * on keys from the same draw, half of them present, through
+ *
+ *     std::lower_bound           plain binary search of the base
+ *     set_adapter                the adapter's own search
+ *     learned_index<set_adapter> the model, at max_error 32
+ *
+ * and the model's build time, size and segment count are reported too.
+ */
+
+#include <vector>
+#include <string>
+#include <algorithm> // lower_bound, max
+#include <cmath> // pow
+#include <cstdint>
+
+#include "bench.hpp"
+#include "../assist/set_adapter.hpp"
+#include "../assist/learned_index.hpp"
+
+namespace {
+
+// A uniform double in [0,1), from i
+inline double unit(std::uint64_t i) {
+    return double(bench::mix(i, 53)) / double(std::uint64_t(1) << 53);
+}
+
+// The i-th key of each distribution, scaled to [0, top)
+inline double uniform(std::uint64_t i, double top) { return unit(i) * top; }
+inline double skewed(std::uint64_t i, double top) {
+    return std::pow(unit(i), 8) * top;
+}
+inline double clustered(std::uint64_t i, double top) {
+    double const centre = unit(i % 64 + ( std::uint64_t(1) << 40 ));
+    return ( centre * 0.999 + unit(i) * 0.001 ) * top;
+}
+
+template < typename K > double top();
+template <> double top<std::uint64_t>() { return 9.2e18; }
+template <> double top<double>() { return 1e9; }
+
+template < typename K >
+void measure(bench::report &out, bench::options const &o,
+             char const *distribution, double (*draw)(std::uint64_t, double),
+             std::size_t n) {
+    typedef assist::set_adapter< std::vector<K> > set_type;
+    std::string const key = std::string(bench::keys<K>::name()) + ":"
+                          + distribution;
+    std::vector<K> keys;
+    keys.reserve(n);
+    for ( std::size_t i = 0; i != n; ++i ) keys.push_back(K(draw(i, top<K>())));
+    set_type const s(keys.begin(), keys.end());
+    std::vector<K> queries;
+    for ( std::size_t i = 0; i != o.ops; ++i ) {
+        queries.push_back(i % 2 ? K(draw(n+i, top<K>()))
+                                : s.begin()[bench::mix(i, 64) % s.size()]);
+    }
+    std::vector<K> const &base = s.base();
+
+    if ( o.wanted("std::lower_bound", key) ) {
+        bench::timing const t = bench::run(queries.size(), o.budget,
+                                           [&](std::size_t i) {
+            bench::keep(std::lower_bound(base.begin(), base.end(), queries[i]));
+        });
+        out.row("lower_bound", "std::lower_bound", key, s.size(), t.ops,
+                t.ns_per_op(), "ns/op");
+    }
+    if ( o.wanted("set_adapter", key) ) {
+        bench::timing const t = bench::run(queries.size(), o.budget,
+                                           [&](std::size_t i) {
+            bench::keep(s.lower_bound(queries[i]));
+        });
+        out.row("lower_bound", "set_adapter", key, s.size(), t.ops,
+                t.ns_per_op(), "ns/op");
+    }
+    char const *const learned = "learned_index<set_adapter>";
+    if ( o.wanted(learned, key) ) {
+        std::size_t const builds = std::max<std::size_t>(1, o.ops / n);
+        assist::learned_index<set_type> *l = 0;
+        double const b = bench::once([&]{
+            for ( std::size_t i = 0; i != builds; ++i ) {
+                delete l;
+                l = new assist::learned_index<set_type>(s);
+            }
+        });
+        out.row("build", learned, key, s.size(), s.size()*builds,
+                b * 1e9 / (s.size()*builds), "ns/element");
+        out.row("memory", learned, key, s.size(), s.size(),
+                double(l->model_size()) / s.size(), "bytes/element");
+        out.row("segments", learned, key, s.size(), s.size(),
+                double(l->segment_count()), "segments");
+        bench::timing const t = bench::run(queries.size(), o.budget,
+                                           [&](std::size_t i) {
+            bench::keep(l->lower_bound(queries[i]));
+        });
+        out.row("lower_bound", learned, key, s.size(), t.ops,
+                t.ns_per_op(), "ns/op");
+        delete l;
+    }
+}
+
+template < typename K >
+void run(bench::report &out, bench::options const &o) {
+    std::vector<std::size_t> const sizes = o.sizes();
+    for ( std::size_t i = 0; i != sizes.size(); ++i ) {
+        measure<K>(out, o, "uniform", uniform, sizes[i]);
+        measure<K>(out, o, "skewed", skewed, sizes[i]);
+        measure<K>(out, o, "clustered", clustered, sizes[i]);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::options const o = bench::parse(argc, argv);
+    bench::report out("learned", o);
+    run<std::uint64_t>(out, o);
+    run<double>(out, o);
+}
@@ -0,0 +1,77 @@
+/*
+ * bench/memory.cpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* Replaces the global operator new and delete with ones that count the
+ * bytes live, for the footprint figures, and the allocations made.
+ * Each block carries its size in a header, so the unsized deletes can
+ * take it off again.  The over-aligned forms aren't replaced, and so
+ * aren't counted.
+ */
+
+#include <new>
+#include <atomic>
+#include <cstdlib> // malloc, free
+#include <cstddef> // size_t, max_align_t
+
+#include "bench.hpp"
+
+namespace {
+
+std::atomic<std::size_t> live(0), count(0);
+
+// Keeps the blocks as aligned as malloc's
+std::size_t const header = alignof(std::max_align_t) < sizeof(std::size_t)
+                           ? sizeof(std::size_t) : alignof(std::max_align_t);
+
+void *allocate(std::size_t n) {
+    char *const p = static_cast<char *>(std::malloc(header + n));
+    if ( !p ) return 0;
+    *reinterpret_cast<std::size_t *>(p) = n;
+    live.fetch_add(n, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    return p + header;
+}
+void deallocate(void *q) {
+    if ( !q ) return;
+    char *const p = static_cast<char *>(q) - header;
+    live.fetch_sub(*reinterpret_cast<std::size_t *>(p),
+                   std::memory_order_relaxed);
+    std::free(p);
+}
+
+} // namespace
+
+std::size_t bench::live_bytes() {
+    return live.load(std::memory_order_relaxed);
+}
+std::size_t bench::allocations() {
+    return count.load(std::memory_order_relaxed);
+}
+
+void *operator new(std::size_t n) {
+    if ( void *const p = allocate(n) ) return p;
+    throw std::bad_alloc();
+}
+void *operator new[](std::size_t n) {
+    if ( void *const p = allocate(n) ) return p;
+    throw std::bad_alloc();
+}
+void *operator new(std::size_t n, std::nothrow_t const &) noexcept {
+    return allocate(n);
+}
+void *operator new[](std::size_t n, std::nothrow_t const &) noexcept {
+    return allocate(n);
+}
+void operator delete(void *p) noexcept { deallocate(p); }
+void operator delete[](void *p) noexcept { deallocate(p); }
+void operator delete(void *p, std::size_t) noexcept { deallocate(p); }
+void operator delete[](void *p, std::size_t) noexcept { deallocate(p); }
+void operator delete(void *p, std::nothrow_t const &) noexcept { deallocate(p); }
+void operator delete[](void *p, std::nothrow_t const &) noexcept { deallocate(p); }
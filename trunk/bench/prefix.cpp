@@ -0,0 +1,119 @@
+/*
+ * bench/prefix.cpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* Longest-prefix match on a routing table of n URL paths, such as
+ * "/3f/a0/7c", one to four segments deep, so that many routes are
+ * prefixes of others.  Three in four queries are a route with more
+ * path after it, the rest random paths.  The table is
+ *
+ *     trie             longest_prefix_match
+ *     map_adapter      upper_bound on the query, then back one; if that
+ *                      key isn't a prefix, cut the query to what they
+ *                      share and go again
+ *
+ * reporting ns/query.  The map_adapter search takes a lower_bound step
+ * per segment it has to back off, where the trie walks down once.
+ */
+
+#include <vector>
+#include <string>
+#include <utility> // pair
+#include <cstdio> // snprintf
+#include <cstdint>
+
+#include "bench.hpp"
+#include "../assist/trie.hpp"
+#include "../assist/map_adapter.hpp"
+
+namespace {
+
+typedef assist::trie<std::string, std::size_t> trie_type;
+typedef assist::map_adapter< std::vector< std::pair<std::string,
+                                                    std::size_t> > >
+    map_type;
+
+// A path of depth segments, each two hex digits, the first few of them
+// from a small set so that the routes share prefixes
+std::string path(std::uint64_t x, unsigned depth) {
+    std::string p;
+    for ( unsigned d = 0; d != depth; ++d ) {
+        unsigned const segment = unsigned(x >> 8*d) & ( d < 2 ? 0x1f : 0xff );
+        char buffer[4];
+        std::snprintf(buffer, sizeof(buffer), "/%02x", segment);
+        p += buffer;
+    }
+    return p;
+}
+std::string route(std::uint64_t i) {
+    std::uint64_t const x = bench::mix(i, 64);
+    return path(x >> 2, 1 + unsigned(x & 3));
+}
+
+// The value of the longest key in m that's a prefix of q, or m.size()
+std::size_t scan(map_type const &m, std::string const &q, std::string &cut) {
+    cut = q;
+    for (;;) {
+        map_type::const_iterator it = m.upper_bound(cut);
+        if ( it == m.begin() ) return m.size();
+        --it;
+        std::string const &k = it->first;
+        std::size_t common = 0;
+        while ( common != k.size() && common != cut.size() &&
+                k[common] == cut[common] ) ++common;
+        if ( common == k.size() ) return it->second;
+        if ( !common ) return m.size();
+        cut.resize(common);
+    }
+}
+
+void measure(bench::report &out, bench::options const &o, std::size_t n) {
+    char const *const key = "str:routes";
+    std::vector< std::pair<std::string, std::size_t> > routes;
+    routes.reserve(n);
+    for ( std::size_t i = 0; i != n; ++i ) {
+        routes.push_back(std::make_pair(route(i), i));
+    }
+    trie_type const t(routes.begin(), routes.end());
+    map_type const m(routes.begin(), routes.end());
+    std::vector<std::string> queries;
+    queries.reserve(o.ops);
+    for ( std::size_t i = 0; i != o.ops; ++i ) {
+        std::uint64_t const x = bench::mix(i, 64);
+        queries.push_back(i % 4 ? route(x % n) + path(x >> 20, 2)
+                                : path(x, 4));
+    }
+
+    if ( o.wanted("trie", key) ) {
+        bench::timing const tm = bench::run(queries.size(), o.budget,
+                                            [&](std::size_t i) {
+            bench::keep(t.longest_prefix_match(queries[i]));
+        });
+        out.row("longest_prefix_match", "trie", key, t.size(), tm.ops,
+                tm.ns_per_op(), "ns/query");
+    }
+    if ( o.wanted("map_adapter", key) ) {
+        std::string cut;
+        bench::timing const tm = bench::run(queries.size(), o.budget,
+                                            [&](std::size_t i) {
+            bench::keep(scan(m, queries[i], cut));
+        });
+        out.row("longest_prefix_match", "map_adapter", key, m.size(), tm.ops,
+                tm.ns_per_op(), "ns/query");
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::options const o = bench::parse(argc, argv);
+    bench::report out("prefix", o);
+    std::vector<std::size_t> const sizes = o.sizes();
+    for ( std::size_t i = 0; i != sizes.size(); ++i ) measure(out, o, sizes[i]);
+}
@@ -0,0 +1,132 @@
+/*
+ * bench/rcu.cpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* rcu_adapter against a set_adapter behind one mutex, with reader
+ * threads looking up random keys while one writer, or none, inserts
+ * batches of 64.  Each run lasts --budget seconds:
+ *
+ *     read             lookups per second, over all readers
+ *     write            batches published per second
+ *
+ * Containers are named for the threads, as "rcu_adapter<set_adapter>/r4w1"
+ * for four readers and a writer; readers go from 1 to --threads by
+ * doubling.  An rcu_adapter write copies the whole set, so writes slow
+ * as n grows, where reads shouldn't.
+ */
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdio> // snprintf
+#include <cstdint>
+
+#include "bench.hpp"
+#include "../assist/set_adapter.hpp"
+#include "../assist/rcu_adapter.hpp"
+
+namespace {
+
+typedef std::uint64_t K;
+typedef assist::set_adapter< std::vector<K> > set_type;
+
+// The same interface as rcu_adapter, for what's measured
+class locked {
+    set_type s;
+    mutable std::mutex m;
+  public:
+    explicit locked(set_type const &initial) : s(initial) {}
+    bool contains(K const &k) const {
+        std::lock_guard<std::mutex> guard(m);
+        return s.contains(k);
+    }
+    template < typename InputIterator >
+    void insert(InputIterator b, InputIterator e) {
+        std::lock_guard<std::mutex> guard(m);
+        s.insert(b, e);
+    }
+};
+
+template < typename Shared >
+void measure(bench::report &out, bench::options const &o, char const *kind,
+             set_type const &initial, std::vector<K> const &hits,
+             std::vector<K> const &fresh, unsigned readers, bool writing) {
+    char name[96];
+    std::snprintf(name, sizeof(name), "%s/r%uw%u", kind, readers,
+                  writing ? 1u : 0u);
+    char const *const key = bench::keys<K>::name();
+    if ( !o.wanted(name, key) ) return;
+
+    Shared shared(initial);
+    std::atomic<bool> stop(false);
+    std::atomic<std::size_t> reads(0), writes(0);
+    std::vector<std::thread> threads;
+    for ( unsigned r = 0; r != readers; ++r ) {
+        threads.push_back(std::thread([&, r]{
+            std::size_t done = 0, found = 0;
+            for ( std::size_t i = r; !stop.load(std::memory_order_relaxed);
+                  i += 7919 ) {
+                found += shared.contains(hits[i % hits.size()]);
+                ++done;
+            }
+            bench::keep(found);
+            reads += done;
+        }));
+    }
+    if ( writing ) {
+        threads.push_back(std::thread([&]{
+            std::size_t done = 0;
+            for ( std::size_t i = 0; !stop.load(std::memory_order_relaxed);
+                  i = ( i + 64 ) % ( fresh.size() - 63 ) ) {
+                shared.insert(fresh.begin() + i, fresh.begin() + i + 64);
+                ++done;
+            }
+            writes += done;
+        }));
+    }
+    bench::clock::time_point const start = bench::clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(o.budget));
+    stop = true;
+    for ( std::size_t i = 0; i != threads.size(); ++i ) threads[i].join();
+    double const s = bench::seconds_since(start);
+
+    out.row("read", name, key, hits.size(), reads, reads / s, "lookups/s");
+    if ( writing ) {
+        out.row("write", name, key, hits.size(), writes, writes / s,
+                "batches/s");
+    }
+}
+
+void run(bench::report &out, bench::options const &o) {
+    std::vector<std::size_t> const sizes = o.sizes();
+    for ( std::size_t i = 0; i != sizes.size(); ++i ) {
+        std::vector<K> const hits = bench::make_keys<K>(0, sizes[i]);
+        std::vector<K> const fresh = bench::make_keys<K>(sizes[i], 64*64);
+        set_type const initial(hits.begin(), hits.end());
+        for ( unsigned readers = 1; readers <= o.threads; readers *= 2 ) {
+            for ( int writing = 0; writing != 2; ++writing ) {
+                measure< assist::rcu_adapter<set_type> >(out, o,
+                    "rcu_adapter<set_adapter>", initial, hits, fresh,
+                    readers, writing != 0);
+                measure<locked>(out, o, "mutex<set_adapter>", initial,
+                    hits, fresh, readers, writing != 0);
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::options const o = bench::parse(argc, argv);
+    bench::report out("rcu", o);
+    run(out, o);
+}
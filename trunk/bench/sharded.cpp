@@ -0,0 +1,136 @@
+/*
+ * bench/sharded.cpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* Throughput against thread count: sharded_multimap_adapter, with a
+ * shard per thread, against a multimap_adapter behind one mutex.  Each
+ * starts with n elements, then every thread runs for --budget seconds
+ * doing
+ *
+ *     insert           random new keys
+ *     contains         random present keys
+ *
+ * reporting operations per second over all threads.  Containers are
+ * named for the threads, as "sharded_multimap_adapter/t4"; threads go
+ * from 1 to --threads by doubling.
+ */
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <utility> // pair
+#include <cstdio> // snprintf
+#include <cstdint>
+
+#include "bench.hpp"
+#include "../assist/multimap_adapter.hpp"
+#include "../assist/sharded_multimap_adapter.hpp"
+
+namespace {
+
+typedef std::uint64_t K;
+typedef std::pair<K, K> P;
+typedef std::vector<P> base_type;
+
+// The same interface as sharded_multimap_adapter, for what's measured
+class locked {
+    assist::multimap_adapter<base_type> m;
+    mutable std::mutex lock;
+  public:
+    locked(base_type const &initial, unsigned)
+     : m(initial.begin(), initial.end()) {}
+    void insert(P const &p) {
+        std::lock_guard<std::mutex> guard(lock);
+        m.insert(p);
+    }
+    bool contains(K const &k) const {
+        std::lock_guard<std::mutex> guard(lock);
+        return m.contains(k);
+    }
+};
+
+class sharded {
+    assist::sharded_multimap_adapter<base_type> m;
+  public:
+    sharded(base_type const &initial, unsigned threads)
+     : m(initial.begin(), initial.end(), threads) {}
+    void insert(P const &p) { m.insert(p); }
+    bool contains(K const &k) const { return m.contains(k); }
+};
+
+template < typename Shared >
+void measure(bench::report &out, bench::options const &o, char const *kind,
+             base_type const &initial, unsigned threads, bool inserting) {
+    char name[96];
+    std::snprintf(name, sizeof(name), "%s/t%u", kind, threads);
+    char const *const key = bench::keys<K>::name();
+    if ( !o.wanted(name, key) ) return;
+
+    Shared shared(initial, threads);
+    std::atomic<bool> stop(false);
+    std::atomic<std::size_t> ops(0);
+    std::vector<std::thread> workers;
+    for ( unsigned t = 0; t != threads; ++t ) {
+        workers.push_back(std::thread([&, t]{
+            std::size_t done = 0, found = 0;
+            // each thread its own stream of keys, past the initial ones
+            std::uint64_t const seed = std::uint64_t(t+1) << 40;
+            for ( std::size_t i = 0; !stop.load(std::memory_order_relaxed);
+                  ++i, ++done ) {
+                std::uint64_t const x = seed + i;
+                if ( inserting ) {
+                    shared.insert(P(bench::keys<K>::make(x), i));
+                } else {
+                    P const &p = initial[bench::mix(x, 64) % initial.size()];
+                    found += shared.contains(p.first);
+                }
+            }
+            bench::keep(found);
+            ops += done;
+        }));
+    }
+    bench::clock::time_point const start = bench::clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(o.budget));
+    stop = true;
+    for ( std::size_t i = 0; i != workers.size(); ++i ) workers[i].join();
+    double const s = bench::seconds_since(start);
+
+    out.row(inserting ? "insert" : "contains", name, key, initial.size(),
+            ops, ops / s, "ops/s");
+}
+
+void run(bench::report &out, bench::options const &o) {
+    std::vector<std::size_t> const sizes = o.sizes();
+    for ( std::size_t i = 0; i != sizes.size(); ++i ) {
+        std::vector<K> const keys = bench::make_keys<K>(0, sizes[i]);
+        base_type initial;
+        initial.reserve(keys.size());
+        for ( std::size_t j = 0; j != keys.size(); ++j ) {
+            initial.push_back(P(keys[j], j));
+        }
+        for ( unsigned threads = 1; threads <= o.threads; threads *= 2 ) {
+            for ( int inserting = 0; inserting != 2; ++inserting ) {
+                measure<sharded>(out, o, "sharded_multimap_adapter",
+                                 initial, threads, inserting != 0);
+                measure<locked>(out, o, "mutex<multimap_adapter>",
+                                initial, threads, inserting != 0);
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::options const o = bench::parse(argc, argv);
+    bench::report out("sharded", o);
+    run(out, o);
+}
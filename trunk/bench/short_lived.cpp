@@ -0,0 +1,115 @@
+/*
+ * bench/short_lived.cpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* Small maps that live for one call: each operation builds a
+ * map_adapter<int, int> of n random keys, looks up 3n keys (a third of
+ * them missing) and destroys it, over
+ *
+ *     map_adapter<std::vector>        the default base_type
+ *     map_adapter<small_vector<16>>   inline storage for 16 elements
+ *     map_adapter<arena vector>       a std::vector drawing from an
+ *                                     arena on a 4096-byte stack buffer
+ *     std::map
+ *
+ * reporting ns and heap allocations per map built.  Here n is the
+ * elements per map, 4 to 128, not --min/--max.
+ */
+
+#include <map>
+#include <vector>
+#include <utility> // pair
+#include <functional> // less
+#include <cstdint>
+
+#include "bench.hpp"
+#include "../assist/map_adapter.hpp"
+#include "../assist/small_vector.hpp"
+#include "../assist/arena_allocator.hpp"
+
+namespace {
+
+typedef std::pair<int, int> P;
+std::size_t const sizes[] = { 4, 12, 32, 128 };
+
+// Builds a map of keys[first, first+n), searches it and destroys it
+template < typename M >
+struct plain_map {
+    static void use(std::vector<int> const &keys, std::size_t first,
+                    std::size_t n) {
+        M m;
+        for ( std::size_t i = 0; i != n; ++i ) {
+            m.insert(P(keys[first+i], int(i)));
+        }
+        std::size_t found = 0;
+        for ( std::size_t i = 0; i != 3*n; ++i ) {
+            found += m.count(keys[first + i % (n + n/2)]);
+        }
+        bench::keep(found);
+    }
+};
+struct arena_map {
+    typedef assist::arena_allocator<P> allocator;
+    typedef assist::map_adapter< std::vector<P, allocator> > M;
+    static void use(std::vector<int> const &keys, std::size_t first,
+                    std::size_t n) {
+        char buffer[4096];
+        assist::arena a(buffer, sizeof(buffer));
+        std::less<int> const cmp;
+        M m(cmp, allocator(a));
+        m.reserve(n);
+        for ( std::size_t i = 0; i != n; ++i ) {
+            m.insert(P(keys[first+i], int(i)));
+        }
+        std::size_t found = 0;
+        for ( std::size_t i = 0; i != 3*n; ++i ) {
+            found += m.count(keys[first + i % (n + n/2)]);
+        }
+        bench::keep(found);
+    }
+};
+
+template < typename U >
+void measure(bench::report &out, bench::options const &o, char const *name,
+             std::vector<int> const &keys, std::size_t n) {
+    if ( !o.wanted(name, "i32") ) return;
+    // each map takes its keys from a different place
+    std::size_t const span = keys.size() - 2*n;
+    std::size_t const before = bench::allocations();
+    bench::timing const t = bench::run(o.ops, o.budget, [&](std::size_t i) {
+        U::use(keys, i*n % span, n);
+    });
+    std::size_t const allocations = bench::allocations() - before;
+    out.row("build_lookup_destroy", name, "i32", n, t.ops, t.ns_per_op(),
+            "ns/map");
+    out.row("allocations", name, "i32", n, t.ops,
+            double(allocations) / t.ops, "allocations/map");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::options const o = bench::parse(argc, argv);
+    bench::report out("short_lived", o);
+    std::vector<int> keys;
+    for ( std::uint64_t i = 0; i != 1 << 16; ++i ) {
+        keys.push_back(int(bench::keys<std::uint32_t>::make(i)));
+    }
+    for ( std::size_t i = 0; i != sizeof(sizes)/sizeof(*sizes); ++i ) {
+        std::size_t const n = sizes[i];
+        measure< plain_map< assist::map_adapter< std::vector<P> > > >(
+            out, o, "map_adapter<std::vector>", keys, n);
+        measure< plain_map< assist::map_adapter<
+                                assist::small_vector<P, 16> > > >(
+            out, o, "map_adapter<small_vector<16>>", keys, n);
+        measure<arena_map>(out, o, "map_adapter<arena vector>", keys, n);
+        measure< plain_map< std::map<int, int> > >(
+            out, o, "std::map", keys, n);
+    }
+}
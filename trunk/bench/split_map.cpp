@@ -0,0 +1,121 @@
+/*
+ * bench/split_map.cpp
+ *
+ * Copyright (c) 2006 Scott McMurray
+ *
+ * Licensed under the Open Software License version 3.0
+ * ( See http://opensource.org/licenses/osl-3.0.php )
+ *
+ */
+
+/* split_map_adapter against map_adapter as the mapped type grows, so
+ * more of each cache line map_adapter searches is spent on values:
+ *
+ *     find_hit         then reading the value found
+ *     lower_bound      random keys, half of them present
+ *     insert_bulk      a batch of new elements in random order through
+ *                      the range insert, ns/element
+ *
+ * Containers are named for the mapped type's size, as "map_adapter/64"
+ * for 64-byte values.
+ */
+
+#include <vector>
+#include <string>
+#include <utility> // pair
+#include <algorithm> // min
+#include <cstdio> // snprintf
+#include <cstdint>
+
+#include "bench.hpp"
+#include "../assist/map_adapter.hpp"
+#include "../assist/split_map_adapter.hpp"
+
+namespace {
+
+template < std::size_t N >
+struct payload {
+    unsigned char bytes[N];
+};
+
+template < typename K >
+struct data {
+    std::size_t n;
+    std::vector<K> hits, misses, mixed;
+    data(std::size_t count, std::size_t ops)
+     : n(count), hits(bench::make_keys<K>(0, count)),
+       misses(bench::make_keys<K>(count, ops)) {
+        for ( std::size_t i = 0; i != ops; ++i ) {
+            mixed.push_back(i % 2 ? misses[i] : hits[i % n]);
+        }
+    }
+};
+
+template < typename M, typename K >
+void measure(bench::report &out, bench::options const &o,
+             char const *kind, data<K> const &d) {
+    typedef typename M::mapped_type V;
+    typedef std::pair<K, V> P;
+    char const *const key = bench::keys<K>::name();
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s/%lu", kind, (unsigned long)sizeof(V));
+    if ( !o.wanted(name, key) ) return;
+
+    V v = V();
+    std::vector<P> elements;
+    elements.reserve(d.n);
+    for ( std::size_t i = 0; i != d.n; ++i ) {
+        v.bytes[0] = (unsigned char)i;
+        elements.push_back(P(d.hits[i], v));
+    }
+    M m(elements.begin(), elements.end());
+    M const &cm = m;
+
+    bench::timing t = bench::run(o.ops, o.budget, [&](std::size_t i) {
+        typename M::const_iterator const it = cm.find(d.hits[i % d.n]);
+        bench::keep(it->second.bytes[0]);
+    });
+    out.row("find_hit", name, key, d.n, t.ops, t.ns_per_op(), "ns/op");
+    t = bench::run(d.mixed.size(), o.budget, [&](std::size_t i) {
+        bench::keep(cm.lower_bound(d.mixed[i]) != cm.end());
+    });
+    out.row("lower_bound", name, key, d.n, t.ops, t.ns_per_op(), "ns/op");
+
+    std::vector<P> batch;
+    for ( std::size_t i = 0, b = std::min(o.ops, d.n); i != b; ++i ) {
+        batch.push_back(P(d.misses[i], v));
+    }
+    double const s = bench::once([&]{ m.insert(batch.begin(), batch.end()); });
+    out.row("insert_bulk", name, key, d.n, batch.size(),
+            s * 1e9 / batch.size(), "ns/element");
+}
+
+template < typename K, std::size_t N >
+void measure_both(bench::report &out, bench::options const &o,
+                  data<K> const &d) {
+    typedef payload<N> V;
+    measure<assist::map_adapter< std::vector< std::pair<K, V> > >, K>(
+        out, o, "map_adapter", d);
+    measure<assist::split_map_adapter< std::vector<K>, std::vector<V> >, K>(
+        out, o, "split_map_adapter", d);
+}
+
+template < typename K >
+void run(bench::report &out, bench::options const &o) {
+    std::vector<std::size_t> const sizes = o.sizes();
+    for ( std::size_t i = 0; i != sizes.size(); ++i ) {
+        data<K> const d(sizes[i], o.ops);
+        measure_both<K, 8>(out, o, d);
+        measure_both<K, 64>(out, o, d);
+        measure_both<K, 256>(out, o, d);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    bench::options const o = bench::parse(argc, argv);
+    bench::report out("split_map", o);
+    run<std::uint32_t>(out, o);
+    run<std::uint64_t>(out, o);
+}